@@ -0,0 +1,147 @@
+/*
+  ==============================================================================
+
+    AllocationTracker.cpp
+    Debug check that nothing allocates on the audio thread: the global
+    operator new and delete, and with glibc malloc, calloc, realloc and free,
+    count and assert while a real-time scope is open on the calling thread.
+    Created: 17 Oct 2026 10:02:51pm
+    Author:  chenzuyu
+
+  ==============================================================================
+*/
+
+#include "AllocationTracker.h"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace
+{
+    thread_local int realtimeDepth = 0;
+    std::atomic<int> numRealtimeAllocations { 0 };
+}
+
+AllocationTracker::ScopedRealtime::ScopedRealtime()
+{
+    ++realtimeDepth;
+}
+
+AllocationTracker::ScopedRealtime::~ScopedRealtime()
+{
+    --realtimeDepth;
+}
+
+bool AllocationTracker::isInRealtimeScope()
+{
+    return realtimeDepth > 0;
+}
+
+int AllocationTracker::getNumRealtimeAllocations()
+{
+    return numRealtimeAllocations.load();
+}
+
+void AllocationTracker::noteAllocation()
+{
+    if (realtimeDepth == 0)
+        return;
+
+    numRealtimeAllocations++;
+
+    // leave the scope while asserting, logging the assertion may allocate itself
+    int depth = realtimeDepth;
+    realtimeDepth = 0;
+    jassertfalse; // something allocated inside processBlock, see the call stack
+    realtimeDepth = depth;
+}
+
+#if DRONE_CHECK_ALLOCATIONS && defined (__GLIBC__)
+ #define DRONE_HOOK_MALLOC 1
+#else
+ #define DRONE_HOOK_MALLOC 0
+#endif
+
+#if DRONE_HOOK_MALLOC
+// glibc exports its allocator under these names too, the hooks forward to them
+extern "C"
+{
+    void* __libc_malloc (std::size_t size);
+    void* __libc_calloc (std::size_t count, std::size_t size);
+    void* __libc_realloc (void* p, std::size_t size);
+    void __libc_free (void* p);
+
+    void* malloc (std::size_t size) noexcept
+    {
+        AllocationTracker::noteAllocation();
+        return __libc_malloc(size);
+    }
+
+    void* calloc (std::size_t count, std::size_t size) noexcept
+    {
+        AllocationTracker::noteAllocation();
+        return __libc_calloc(count, size);
+    }
+
+    void* realloc (void* p, std::size_t size) noexcept
+    {
+        AllocationTracker::noteAllocation();
+        return __libc_realloc(p, size);
+    }
+
+    // freeing takes the allocator's lock as well
+    void free (void* p) noexcept
+    {
+        if (p != nullptr)
+            AllocationTracker::noteAllocation();
+
+        __libc_free(p);
+    }
+}
+#endif
+
+#if DRONE_CHECK_ALLOCATIONS
+// The sized, nothrow and array forms of the standard library all end up here.
+// With the malloc hooks std::malloc and std::free do the counting
+void* operator new (std::size_t size)
+{
+   #if ! DRONE_HOOK_MALLOC
+    AllocationTracker::noteAllocation();
+   #endif
+
+    if (void* p = std::malloc(size == 0 ? 1 : size))
+        return p;
+
+    throw std::bad_alloc();
+}
+
+void* operator new[] (std::size_t size)
+{
+    return operator new (size);
+}
+
+void operator delete (void* p) noexcept
+{
+   #if ! DRONE_HOOK_MALLOC
+    if (p != nullptr)
+        AllocationTracker::noteAllocation();
+   #endif
+
+    std::free(p);
+}
+
+void operator delete[] (void* p) noexcept
+{
+    operator delete (p);
+}
+
+void operator delete (void* p, std::size_t) noexcept
+{
+    operator delete (p);
+}
+
+void operator delete[] (void* p, std::size_t) noexcept
+{
+    operator delete (p);
+}
+#endif
@@ -0,0 +1,54 @@
+/*
+  ==============================================================================
+
+    AllocationTracker.h
+    Debug check that nothing allocates on the audio thread: the global
+    operator new and delete, and with glibc malloc, calloc, realloc and free,
+    count and assert while a real-time scope is open on the calling thread.
+    Created: 17 Oct 2026 10:02:51pm
+    Author:  chenzuyu
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <JuceHeader.h>
+
+// On in debug builds. Set to 0 to keep the standard operator new and delete,
+// e.g. when another library in the same binary replaces them as well.
+// The C allocation functions are only hooked with glibc (Linux), and only where the
+// dynamic linker resolves them to ours: the standalone and DroneBench, not a plugin
+// loaded into a host with its own allocator. On macOS and Windows a malloc made
+// directly, rather than through operator new, goes unnoticed
+#ifndef DRONE_CHECK_ALLOCATIONS
+ #if JUCE_DEBUG
+  #define DRONE_CHECK_ALLOCATIONS 1
+ #else
+  #define DRONE_CHECK_ALLOCATIONS 0
+ #endif
+#endif
+
+class AllocationTracker
+{
+public:
+    static constexpr bool isEnabled() { return DRONE_CHECK_ALLOCATIONS != 0; }
+
+    // Allocations and frees made inside a real-time scope, on any thread
+    static int getNumRealtimeAllocations();
+
+    static bool isInRealtimeScope(); // on the calling thread
+    static void noteAllocation();    // called by the hooked allocation functions, freeing too
+
+    // Marks the enclosing scope of the calling thread as real-time, use through the macro below
+    struct ScopedRealtime
+    {
+        ScopedRealtime();
+        ~ScopedRealtime();
+    };
+};
+
+#if DRONE_CHECK_ALLOCATIONS
+ #define DRONE_REALTIME_SCOPE AllocationTracker::ScopedRealtime realtimeScope
+#else
+ #define DRONE_REALTIME_SCOPE
+#endif
@@ -11,83 +11,140 @@
 
 #pragma once
 
+// How a fractional delay time is read from the line
+enum class DelayInterpolation
+{
+    None,      // integer part only
+    Linear,
+    Hermite,   // 4-point cubic Hermite (Catmull-Rom)
+    Lagrange3, // 4-point 3rd-order Lagrange
+    Thiran     // 1st-order Thiran allpass, flat magnitude but keeps state
+};
+
 class Delay
 {
     
 public:
     
+    Delay() = default;
+    
     // Setters
     void setDelaySamples(float newDelay)
     {
-        delaySamples = newDelay;
-        
         // constrain delay time to size of the delay line
-        if ( delaySamples >= size)
-            delaySamples = size - 1;
+        delaySamples = juce::jlimit(0.0f, maxDelay, newDelay);
+    }
+    
+    // Floats of memory a line of up to maxSize samples needs, see setMemory
+    static int getRequiredMemory(int maxSize)
+    {
+        return juce::nextPowerOfTwo(juce::jmax(2, maxSize) + 2) + numGuardSamples;
+    }
+    
+    // Run the line in preallocated memory of getRequiredMemory(maxSize) floats, owned
+    // by the caller. setBufferSize then never allocates for sizes up to maxSize
+    void setMemory(float* memory, int maxSize)
+    {
+        externalMemory = memory;
+        externalMaxSize = maxSize;
+    }
+    
+    void setBufferSize(int newSize)
+    {
+        // preallocated memory only holds lines up to the size it was made for
+        if (externalMemory != nullptr)
+        {
+            jassert(newSize <= externalMaxSize);
+            newSize = juce::jmin(newSize, externalMaxSize);
+        }
         
-        // set readPos relative to delay time
-        readPos = writePos - delaySamples;
+        // the ring buffer is rounded up to a power of two, with room for the two taps the cubic
+        // kernels read past the delay time, plus three guard samples mirroring the start of the line
+        size = juce::nextPowerOfTwo(juce::jmax(2, newSize) + 2);
+        mask = size - 1;
+        maxDelay = (float) (juce::jmax(2, newSize) - 1);
         
-        // constrain the read head
-        if (readPos < 0)
-            readPos = 0;
-            
+        if (externalMemory != nullptr)
+        {
+            buffer = externalMemory;
+            std::fill(buffer, buffer + size + numGuardSamples, 0.0f);
+        }
+        else
+        {
+            ownedBuffer.assign(size + numGuardSamples, 0.0f);
+            buffer = ownedBuffer.data();
+        }
+        writePos = 0;
+        delaySamples = juce::jmin(delaySamples, maxDelay);
+        allpassInput = allpassOutput = 0.0f;
     }
     
-    void setBufferSize(int newSize)
+    void setInterpolation(DelayInterpolation newInterpolation)
     {
-        size = newSize;
-        buffer.resize(size);
+        interpolation = newInterpolation;
     }
     
+    DelayInterpolation getInterpolation() const { return interpolation; }
+    
     void setDryWet(float dw)
     {
         dryWet = dw;
     }
     
+    // read the sample at the integer part of the delay time
     float readSample()
     {
-        float output = buffer[readPos];
-        
-        // increment read head (update)
-        readPos ++;
-        
-        // wrap read head
-//        readPos %= size;
-        if (readPos >= size)
-            readPos -= size;
-        
-        return output;
+        return buffer[(writePos - (int) delaySamples) & mask];
     }
     
     
-  // when the readPos is not an integer, use interpolation
+  // when the delay time is not an integer, use interpolation
     float linearInterp()
     {
-        // bound the read head
-        if (readPos >= size)
-            readPos -= size;
-        
-        int lowerPos = floor(readPos);
-        int higherPos = lowerPos + 1;
-        
-        float frac = readPos - lowerPos;
+        return read<DelayInterpolation::Linear>(buffer, writePos, delaySamples);
+    }
     
-        float output = (1 - frac) * buffer[lowerPos] + frac * buffer[higherPos];
-        
-        return output;
+    // read with the selected interpolation
+    float readFractional()
+    {
+        switch (interpolation)
+        {
+            case DelayInterpolation::None:      return readSample();
+            case DelayInterpolation::Linear:    return linearInterp();
+            case DelayInterpolation::Hermite:   return read<DelayInterpolation::Hermite>(buffer, writePos, delaySamples);
+            case DelayInterpolation::Lagrange3: return read<DelayInterpolation::Lagrange3>(buffer, writePos, delaySamples);
+            case DelayInterpolation::Thiran:    return read<DelayInterpolation::Thiran>(buffer, writePos, delaySamples);
+        }
+        return linearInterp();
     }
     
     void writeSample(float inputSample)
     {
-        buffer[writePos] = inputSample;
+        write(buffer, writePos, inputSample);
         
-        // increment writePos
-        writePos ++;
+        // increment and wrap writePos
+        writePos = (writePos + 1) & mask;
+    }
+    
+    // Block access for structures that close their own loop around the line (see FDNReverb):
+    // read numSamples at the integer delay time, then write numSamples back. Every read
+    // sample is already in the line as long as numSamples <= the delay time
+    void readBlock(float* dest, int numSamples) const
+    {
+        jassert(numSamples <= (int) delaySamples);
         
-        // wrap
-        if (writePos >= size)
-            writePos -= size;
+        int readPos = writePos - (int) delaySamples;
+        for (int i = 0; i < numSamples; i++)
+            dest[i] = buffer[(readPos + i) & mask];
+    }
+    
+    void writeBlock(const float* src, int numSamples)
+    {
+        for (int i = 0; i < numSamples; i++)
+        {
+            write(buffer, writePos, src[i]);
+            writePos = (writePos + 1) & mask;
+        }
     }
     
     void setFeedbackGain(float _fb)
@@ -105,7 +162,7 @@ public:
         if (feedBack) // feedback comb filter
         {
             // read the sample with linear interpolation: g * y[n - M]
-            float feedbackSample = feedbackGain * linearInterp();
+            float feedbackSample = feedbackGain * readFractional();
             // add scaled feedback sample to the input:
             // y[n] = x[n] + g*y[n - M]
             output = inputSample + feedbackSample;
@@ -114,21 +171,169 @@ public:
         else // feedforward comb filter
         {
             // y[n] = x[n] + g*x[n - M]
-            output = inputSample + feedbackGain * linearInterp();
+            output = inputSample + feedbackGain * readFractional();
             writeSample(inputSample);
         }
         // mix the dry intput signal with the processed output signal:
         return inputSample * (1 - dryWet) + output * dryWet;
     }
     
+    // Block version: the delay time (in samples) and, if given, the feedback gain
+    // are read per sample from buffers, so nothing needs to be set per sample.
+    // input and output may point to the same buffer.
+    void process(const float* input, float* output, int numSamples,
+                 const float* delayTimes, const float* feedbackGains, bool feedBack)
+    {
+        // pick the kernel once per block, each loop is compiled for one interpolator
+        switch (interpolation)
+        {
+            case DelayInterpolation::None:
+                processBlock<DelayInterpolation::None>(input, output, numSamples, delayTimes, feedbackGains, feedBack);
+                break;
+            case DelayInterpolation::Linear:
+                processBlock<DelayInterpolation::Linear>(input, output, numSamples, delayTimes, feedbackGains, feedBack);
+                break;
+            case DelayInterpolation::Hermite:
+                processBlock<DelayInterpolation::Hermite>(input, output, numSamples, delayTimes, feedbackGains, feedBack);
+                break;
+            case DelayInterpolation::Lagrange3:
+                processBlock<DelayInterpolation::Lagrange3>(input, output, numSamples, delayTimes, feedbackGains, feedBack);
+                break;
+            case DelayInterpolation::Thiran:
+                processBlock<DelayInterpolation::Thiran>(input, output, numSamples, delayTimes, feedbackGains, feedBack);
+                break;
+        }
+    }
+
     private:
+    template <DelayInterpolation mode>
+    void processBlock(const float* input, float* output, int numSamples,
+                      const float* delayTimes, const float* feedbackGains, bool feedBack)
+    {
+        // a missing gain buffer reads the current gain with a stride of 0
+        const float* gains = (feedbackGains != nullptr) ? feedbackGains : &feedbackGain;
+        const int gainStride = (feedbackGains != nullptr) ? 1 : 0;
+        const float feedbackMix = feedBack ? 1.0f : 0.0f; // what is written: y[n] or x[n]
+
+        float* buf = buffer;
+        int w = writePos;
+
+        for (int i = 0; i < numSamples; i++)
+        {
+            float delay = juce::jlimit(0.0f, maxDelay, delayTimes[i]);
+            float g = juce::jmin(gains[i * gainStride], 1.0f);
+            float x = input[i];
+
+            // y[n] = x[n] + g*y[n - M] (feedback) or x[n] + g*x[n - M] (feedforward)
+            float y = x + g * read<mode>(buf, w, delay);
+
+            write(buf, w, x + feedbackMix * (y - x));
+            w = (w + 1) & mask;
+
+            output[i] = x * (1 - dryWet) + y * dryWet;
+        }
+
+        writePos = w;
+        if (numSamples > 0)
+            delaySamples = juce::jlimit(0.0f, maxDelay, delayTimes[numSamples - 1]);
+    }
+
+    // Read kernels M samples behind the write head, no branches: the integer
+    // part of M is wrapped with the mask and the guard samples cover the reads
+    // past the end. The fraction is taken from M alone, so its precision does
+    // not depend on the buffer size. Only the kernel for `mode` is compiled in.
+    template <DelayInterpolation mode>
+    float read(const float* buf, int w, float delay)
+    {
+        int wholeDelay = (int) delay;
+        float t = delay - wholeDelay; // 0 at x[n - M], 1 at x[n - M - 1]
+        
+        if constexpr (mode == DelayInterpolation::None)
+        {
+            return buf[(w - wholeDelay) & mask];
+        }
+        else if constexpr (mode == DelayInterpolation::Linear)
+        {
+            float frac = 1.0f - t;
+            int lowerPos = (w - wholeDelay - 1) & mask;
+            
+            return buf[lowerPos] + frac * (buf[lowerPos + 1] - buf[lowerPos]);
+        }
+        else if constexpr (mode == DelayInterpolation::Hermite || mode == DelayInterpolation::Lagrange3)
+        {
+            // four taps around the read point, y0 is the newest
+            int base = (w - wholeDelay - 2) & mask;
+            float y3 = buf[base];
+            float y2 = buf[base + 1];
+            float y1 = buf[base + 2];
+            float y0 = buf[base + 3];
+            
+            if constexpr (mode == DelayInterpolation::Hermite)
+            {
+                float c1 = 0.5f * (y2 - y0);
+                float c2 = y0 - 2.5f * y1 + 2.0f * y2 - 0.5f * y3;
+                float c3 = 0.5f * (y3 - y0) + 1.5f * (y1 - y2);
+                
+                return ((c3 * t + c2) * t + c1) * t + y1;
+            }
+            else
+            {
+                // Lagrange basis on the taps at -1, 0, 1, 2
+                float tp1 = t + 1.0f;
+                float tm1 = t - 1.0f;
+                float tm2 = t - 2.0f;
+                
+                return (-t * tm1 * tm2 * (1.0f / 6.0f)) * y0
+                     + (tp1 * tm1 * tm2 * 0.5f) * y1
+                     + (-tp1 * t * tm2 * 0.5f) * y2
+                     + (tp1 * t * tm1 * (1.0f / 6.0f)) * y3;
+            }
+        }
+        else // Thiran
+        {
+            // keep the allpass delay in 0.5 ~ 1.5 where the first-order Thiran filter is
+            // accurate and stable: tap the line at M - d and let the allpass add d
+            int tapDelay = juce::jmax(0, (int) (delay - 0.5f));
+            float d = delay - tapDelay;
+            float eta = (1.0f - d) / (1.0f + d);
+            
+            // y[n] = eta*x[n] + x[n - 1] - eta*y[n - 1]
+            float x = buf[(w - tapDelay) & mask];
+            float y = eta * (x - allpassOutput) + allpassInput;
+            allpassInput = x;
+            allpassOutput = y;
+            
+            return y;
+        }
+    }
+    
+    // write one sample and mirror it into the guard samples, branch-free:
+    // for w < numGuardSamples the second store lands on the guard copy,
+    // otherwise it rewrites the same position
+    void write(float* buf, int w, float value)
+    {
+        buf[w] = value;
+        buf[w + (w < numGuardSamples ? size : 0)] = value;
+    }
+
     // member variables
-    float delaySamples;
+    float delaySamples = 0;
+    float maxDelay = 0;
     
-    std::vector<float> buffer; //delay line
-    int size; // buffer size
-    float readPos = 0;
-    float writePos = 0;
+    static constexpr int numGuardSamples = 3;
+    float* buffer = nullptr; //delay line, size + numGuardSamples samples
+    std::vector<float> ownedBuffer; // the line's memory when none was given to setMemory
+    float* externalMemory = nullptr;
+    int externalMaxSize = 0;
+    int size = 0; // power of two
+    int mask = 0;
+    int writePos = 0;
     float dryWet = 1; // 0 ~ 1
     float feedbackGain = 0.9; // 0 ~ 1, acts as a loss factor
+    
+    DelayInterpolation interpolation = DelayInterpolation::Linear;
+    float allpassInput = 0; // Thiran allpass state
+    float allpassOutput = 0;
+    
+    JUCE_DECLARE_NON_COPYABLE (Delay) // buffer may point into ownedBuffer
 };
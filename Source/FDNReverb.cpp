@@ -0,0 +1,271 @@
+/*
+  ==============================================================================
+
+    FDNReverb.cpp
+    Feedback delay network reverb on 16 Delay lines: the line outputs are
+    damped, mixed by a lossless matrix applied as a fast transform and fed
+    back with the input. Whole chunks go round the loop at once, so every
+    step is a loop over a block of samples rather than a per-sample call.
+    Created: 18 Oct 2026 1:12:45am
+    Author:  chenzuyu
+
+  ==============================================================================
+*/
+
+#include "FDNReverb.h"
+
+namespace
+{
+    // Line lengths at 48 kHz, 31 ~ 98 ms: primes spaced geometrically so that no two lines
+    // share echoes. Even lines go to the left, odd ones to the right, short and long on both sides
+    constexpr int baseLengths[FDNReverb::numLines] = {
+        1511, 1619, 1747, 1889, 2039, 2203, 2371, 2557,
+        2767, 2999, 3217, 3467, 3761, 4049, 4357, 4703
+    };
+    constexpr double baseSampleRate = 48000.0;
+
+    int getMaxLineLength(double maxSampleRate)
+    {
+        return (int) std::ceil(baseLengths[FDNReverb::numLines - 1] * maxSampleRate / baseSampleRate) + 1;
+    }
+
+    // each channel feeds and taps half the lines, at unit power overall
+    const float channelGain = 1.0f / std::sqrt(FDNReverb::numLines / 2.0f);
+}
+
+size_t FDNReverb::getRequiredMemory(double maxSampleRate)
+{
+    return numLines * MemoryArena::getSliceSize((size_t) Delay::getRequiredMemory(getMaxLineLength(maxSampleRate)));
+}
+
+void FDNReverb::prepare(double newSampleRate, double maxSampleRate, MemoryArena& arena)
+{
+    jassert(newSampleRate <= maxSampleRate);
+    sampleRate = (float) juce::jmin(newSampleRate, maxSampleRate);
+    int maxLength = getMaxLineLength(maxSampleRate);
+
+    for (int k = 0; k < numLines; k++)
+    {
+        lines[k].setMemory(arena.allocate((size_t) Delay::getRequiredMemory(maxLength)), maxLength);
+
+        // never shorter than a chunk, see processChunk
+        lineLengths[k] = juce::jmax(maxChunkSize + 1, juce::roundToInt(baseLengths[k] * sampleRate / baseSampleRate));
+    }
+
+    // the ramps start from the settings made so far
+    decay.reset(sampleRate, rampSeconds);
+    mix.reset(sampleRate, rampSeconds);
+    decayTime = decay.getCurrentValue();
+
+    prepared = true;
+    idle = false;
+    reset();
+    updateGains();
+}
+
+void FDNReverb::reset()
+{
+    if (! prepared)
+        return;
+
+    for (int k = 0; k < numLines; k++)
+    {
+        lines[k].setBufferSize(lineLengths[k] + 1);
+        lines[k].setDelaySamples((float) lineLengths[k]);
+        dampingStates[k] = 0.0f;
+    }
+}
+
+void FDNReverb::setDecayTime(float seconds)
+{
+    decay.setTargetValue(juce::jmax(0.01f, seconds));
+
+    // without a ramp to follow, processChunk would never pick it up
+    if (! decay.isSmoothing() && decay.getCurrentValue() != decayTime)
+    {
+        decayTime = decay.getCurrentValue();
+        updateGains();
+    }
+}
+
+void FDNReverb::setDamping(float cutoffHz)
+{
+    if (cutoffHz == dampingCutoff)
+        return;
+
+    dampingCutoff = cutoffHz;
+    updateGains();
+}
+
+void FDNReverb::setMix(float wet)
+{
+    mix.setTargetValue(juce::jlimit(0.0f, 1.0f, wet));
+}
+
+void FDNReverb::setMixing(FDNMixing newMixing)
+{
+    mixing = newMixing;
+    updateGains();
+}
+
+void FDNReverb::updateGains()
+{
+    // -60 dB after decayTime: each pass round line k loses 60 dB * length / (decayTime * fs).
+    // The Hadamard butterflies leave out their 1/sqrt(N), it is applied here instead
+    float normalise = mixing == FDNMixing::Hadamard ? 1.0f / std::sqrt((float) numLines) : 1.0f;
+
+    for (int k = 0; k < numLines; k++)
+        lineGains[k] = normalise * std::pow(10.0f, -3.0f * lineLengths[k] / (decayTime * sampleRate));
+
+    float cutoff = juce::jlimit(20.0f, 0.49f * sampleRate, dampingCutoff);
+    dampingCoeff = 1.0f - std::exp(-juce::MathConstants<float>::twoPi * cutoff / sampleRate);
+}
+
+void FDNReverb::process(float* left, float* right, int numSamples)
+{
+    if (! prepared)
+        return;
+
+    // nothing to add at mix 0, and nothing fed in: what is left in the lines is stale by the time it returns
+    if (mix.getTargetValue() == 0.0f && ! mix.isSmoothing())
+    {
+        idle = true;
+        return;
+    }
+
+    if (idle)
+    {
+        reset();
+        idle = false;
+    }
+
+    for (int start = 0; start < numSamples; start += maxChunkSize)
+    {
+        int n = juce::jmin(maxChunkSize, numSamples - start);
+        processChunk(left + start, right != nullptr ? right + start : nullptr, n);
+    }
+}
+
+void FDNReverb::processChunk(float* left, float* right, int numSamples)
+{
+    // the decay ramps once per chunk, the line gains follow
+    if (decay.isSmoothing())
+    {
+        decayTime = decay.skip(numSamples);
+        updateGains();
+    }
+
+    // 1. the line outputs: every line is longer than the chunk, so none of these
+    // samples depends on what this chunk writes
+    for (int k = 0; k < numLines; k++)
+        lines[k].readBlock(rows[k], numSamples);
+
+    // 2. tap the outputs, with alternating signs so the two channels decorrelate
+    std::fill(wetLeft, wetLeft + numSamples, 0.0f);
+    std::fill(wetRight, wetRight + numSamples, 0.0f);
+    for (int k = 0; k < numLines; k++)
+    {
+        float* wet = k % 2 == 0 ? wetLeft : wetRight;
+        float gain = (k / 2) % 2 == 0 ? channelGain : -channelGain;
+        const float* row = rows[k];
+
+        for (int i = 0; i < numSamples; i++)
+            wet[i] += gain * row[i];
+    }
+
+    // 3. damping and decay, the one recursive step, per line
+    for (int k = 0; k < numLines; k++)
+    {
+        float* row = rows[k];
+        float state = dampingStates[k];
+        float gain = lineGains[k];
+
+        for (int i = 0; i < numSamples; i++)
+        {
+            state += dampingCoeff * (row[i] - state);
+            row[i] = gain * state;
+        }
+
+        JUCE_SNAP_TO_ZERO(state);
+        dampingStates[k] = state;
+    }
+
+    // 4. feedback matrix
+    switch (mixing)
+    {
+        case FDNMixing::Hadamard:    mixLines<FDNMixing::Hadamard>(numSamples);    break;
+        case FDNMixing::Householder: mixLines<FDNMixing::Householder>(numSamples); break;
+    }
+
+    // 5. the input joins the feedback and the chunk goes back into the lines
+    for (int k = 0; k < numLines; k++)
+    {
+        const float* input = (right != nullptr && k % 2 == 1) ? right : left;
+        float* row = rows[k];
+
+        for (int i = 0; i < numSamples; i++)
+            row[i] += channelGain * input[i];
+
+        lines[k].writeBlock(row, numSamples);
+    }
+
+    // 6. dry/wet, in place, the mix ramps per sample
+    for (int i = 0; i < numSamples; i++)
+        mixRamp[i] = mix.getNextValue();
+
+    if (right != nullptr)
+    {
+        for (int i = 0; i < numSamples; i++)
+        {
+            left[i] += mixRamp[i] * (wetLeft[i] - left[i]);
+            right[i] += mixRamp[i] * (wetRight[i] - right[i]);
+        }
+    }
+    else
+    {
+        for (int i = 0; i < numSamples; i++)
+            left[i] += mixRamp[i] * (0.5f * (wetLeft[i] + wetRight[i]) - left[i]);
+    }
+}
+
+template <FDNMixing mode>
+void FDNReverb::mixLines(int numSamples)
+{
+    if constexpr (mode == FDNMixing::Hadamard)
+    {
+        // fast Walsh-Hadamard transform: log2(N) stages of add/subtract butterflies
+        // between pairs of lines, N*log2(N) adds per sample instead of N*N multiply-adds
+        for (int stride = 1; stride < numLines; stride *= 2)
+        {
+            for (int start = 0; start < numLines; start += 2 * stride)
+            {
+                for (int k = start; k < start + stride; k++)
+                {
+                    float* a = rows[k];
+                    float* b = rows[k + stride];
+
+                    for (int i = 0; i < numSamples; i++)
+                    {
+                        float x = a[i];
+                        float y = b[i];
+                        a[i] = x + y;
+                        b[i] = x - y;
+                    }
+                }
+            }
+        }
+    }
+    else
+    {
+        // I - 2/N * ones: subtract the scaled sum of all lines from each
+        std::fill(lineSum, lineSum + numSamples, 0.0f);
+        for (int k = 0; k < numLines; k++)
+            for (int i = 0; i < numSamples; i++)
+                lineSum[i] += rows[k][i];
+
+        const float scale = 2.0f / numLines;
+        for (int k = 0; k < numLines; k++)
+            for (int i = 0; i < numSamples; i++)
+                rows[k][i] -= scale * lineSum[i];
+    }
+}
@@ -0,0 +1,85 @@
+/*
+  ==============================================================================
+
+    FDNReverb.h
+    Feedback delay network reverb on 16 Delay lines: the line outputs are
+    damped, mixed by a lossless matrix applied as a fast transform and fed
+    back with the input. Whole chunks go round the loop at once, so every
+    step is a loop over a block of samples rather than a per-sample call.
+    Created: 18 Oct 2026 1:12:45am
+    Author:  chenzuyu
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <JuceHeader.h>
+#include "Delay.h"
+#include "MemoryArena.h"
+
+// How the line outputs are mixed back into the line inputs, both orthogonal (lossless)
+enum class FDNMixing
+{
+    Hadamard,   // every line feeds every other at equal weight, log2(N) add/subtract stages
+    Householder // reflection I - 2/N: one sum over the lines, one subtract per line
+};
+
+class FDNReverb
+{
+public:
+    static constexpr int numLines = 16;
+    static constexpr int maxChunkSize = 256; // the shortest line is longer, so a chunk is read out before it is written back
+
+    // Floats of arena memory the lines need to run at up to maxSampleRate, see prepare
+    static size_t getRequiredMemory(double maxSampleRate);
+
+    // Lay the lines out in the arena for this sample rate and clear them, real-time safe
+    void prepare(double sampleRate, double maxSampleRate, MemoryArena& arena);
+    void reset();
+
+    // The decay time and the mix ramp over rampSeconds once prepared, settings made
+    // before prepare take effect at once
+    void setDecayTime(float seconds); // RT60 at low frequencies
+    void setDamping(float cutoffHz); // above this the tail dies away faster
+    void setMix(float wet); // 0 dry ~ 1 wet
+    void setMixing(FDNMixing newMixing);
+    float getMix() const { return mix.getTargetValue(); }
+
+    // In place, the even lines feed and tap the left channel and the odd ones the right.
+    // right == nullptr for mono. Skipped once the mix has ramped down to 0, the lines are
+    // cleared when it comes back up so the tail from before does not play again
+    void process(float* left, float* right, int numSamples);
+
+private:
+    void processChunk(float* left, float* right, int numSamples);
+    template <FDNMixing mode>
+    void mixLines(int numSamples);
+    void updateGains();
+
+    Delay lines[numLines];
+    int lineLengths[numLines] = {};
+    bool prepared = false;
+
+    float sampleRate = 48000.0f;
+    float decayTime = 6.0f; // the line gains are set for this, it follows the ramp once per chunk
+    float dampingCutoff = 6000.0f;
+    FDNMixing mixing = FDNMixing::Hadamard;
+    bool idle = false; // skipped at mix 0, cleared before it runs again
+
+    static constexpr double rampSeconds = 0.05;
+    juce::SmoothedValue<float, juce::ValueSmoothingTypes::Multiplicative> decay { 6.0f };
+    juce::SmoothedValue<float> mix { 0.0f };
+
+    // Per line: the decay gain for its length, with the Hadamard normalisation folded in,
+    // and the state of its one-pole damping filter
+    float lineGains[numLines] = {};
+    float dampingCoeff = 1.0f;
+    float dampingStates[numLines] = {};
+
+    // One chunk of every line, line-major so each stage is a plain loop over samples
+    float rows[numLines][maxChunkSize];
+    float wetLeft[maxChunkSize];
+    float wetRight[maxChunkSize];
+    float mixRamp[maxChunkSize];
+    float lineSum[maxChunkSize]; // Householder
+};
@@ -0,0 +1,181 @@
+/*
+  ==============================================================================
+
+    FastMath.h
+    Float-only approximations of tanh, sin and exp2 for the oscillators and
+    saturating stages, in three accuracy tiers. Each kernel has a scalar and a
+    block version; the block versions are branch-free loops over arrays, which
+    the compiler vectorises.
+    Created: 17 Oct 2026 11:24:09pm
+    Author:  chenzuyu
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+
+// How the oscillators evaluate their waveshapes when no wavetable is set
+enum class MathAccuracy {
+    Exact, // libm in double precision, the reference
+    High,  // max error about 2e-7 (tanh, sin) or 2e-7 relative (exp2)
+    Fast   // max error about 2e-2 (tanh), 7e-5 (sin) or 3e-3 relative (exp2)
+};
+
+namespace FastMath
+{
+    // The kernels below expect their input already clamped. The clamp is a separate pass
+    // in the block versions: folded into the same loop the compiler turns the clamped
+    // (constant) results into branches and gives up on vectorising the loop
+    namespace detail
+    {
+        inline float clamp(float x, float lowest, float highest)
+        {
+            return std::min(std::max(x, lowest), highest);
+        }
+
+        inline void clamp(const float* src, float* dest, int numSamples, float lowest, float highest)
+        {
+            for (int i = 0; i < numSamples; i++)
+                dest[i] = clamp(src[i], lowest, highest);
+        }
+
+        // 2^x for x in -126 ~ 127. The integer part goes straight into the float
+        // exponent, the fraction through a minimax polynomial
+        template <MathAccuracy accuracy>
+        inline float exp2Kernel(float x)
+        {
+            // floor without a libm call, for negative integers f comes out as 1, which is still exact
+            std::int32_t whole = (std::int32_t) x - (std::int32_t) (x < 0.0f);
+            float f = x - (float) whole;
+            float p;
+
+            if constexpr (accuracy == MathAccuracy::High)
+                p = 0.999999893f + f * (0.693154752f + f * (0.240139712f + f * (0.0558662447f + f * (0.00894283084f + f * 0.00189646041f))));
+            else
+                p = 1.00247599f + f * (0.651047254f + f * 0.344000639f);
+
+            // scale by 2^whole through the exponent bits, p is in 1 ~ 2 so the mantissa is untouched
+            std::int32_t bits;
+            std::memcpy(&bits, &p, sizeof(bits));
+            bits += whole * (1 << 23);
+            std::memcpy(&p, &bits, sizeof(p));
+            return p;
+        }
+
+        // tanh(x) for |x| <= 9 (High) or 3 (Fast)
+        template <MathAccuracy accuracy>
+        inline float tanhKernel(float x)
+        {
+            if constexpr (accuracy == MathAccuracy::High)
+            {
+                // 1 - 2/(e^2|x| + 1)
+                float e = exp2Kernel<MathAccuracy::High>(std::abs(x) * 2.88539008f);
+                return std::copysign(1.0f - 2.0f / (e + 1.0f), x);
+            }
+            else
+            {
+                float x2 = x * x;
+                return x * (27.0f + x2) / (27.0f + 9.0f * x2);
+            }
+        }
+
+        template <MathAccuracy accuracy>
+        constexpr float tanhLimit = accuracy == MathAccuracy::High ? 9.0f : 3.0f; // tanh(9) rounds to 1 in float
+    }
+
+    // 2^x, x clamped to the normal range -126 ~ 127.
+    // High: degree 5 polynomial, max relative error 1.8e-7. Fast: degree 2, max relative error 2.5e-3
+    template <MathAccuracy accuracy>
+    inline float exp2(float x)
+    {
+        if constexpr (accuracy == MathAccuracy::Exact)
+            return (float) std::exp2((double) x);
+        else
+            return detail::exp2Kernel<accuracy>(detail::clamp(x, -126.0f, 127.0f));
+    }
+
+    // tanh(x). High: from exp2, max error 1.6e-7.
+    // Fast: [3/2] Pade approximant x(27 + x^2)/(27 + 9x^2), clamped at |x| = 3, max error 2.4e-2
+    template <MathAccuracy accuracy>
+    inline float tanh(float x)
+    {
+        if constexpr (accuracy == MathAccuracy::Exact)
+            return (float) std::tanh((double) x);
+        else
+            return detail::tanhKernel<accuracy>(detail::clamp(x, -detail::tanhLimit<accuracy>, detail::tanhLimit<accuracy>));
+    }
+
+    // sin(2*pi*phase) for a phase in [0, 1], the form the oscillators need. The phase is
+    // folded onto the quarter wave [0, 0.25] and fed to an odd minimax polynomial.
+    // High: degree 9, max error 2e-7. Fast: degree 5, max error 6.8e-5
+    template <MathAccuracy accuracy>
+    inline float sin2Pi(float phase)
+    {
+        if constexpr (accuracy == MathAccuracy::Exact)
+        {
+            return (float) std::sin(2 * M_PI * phase);
+        }
+        else
+        {
+            // sin(2*pi*p) = sin(2*pi*x) for x = 0.5 - p in [-0.5, 0.5], and sin(2*pi*x)
+            // is odd and mirrors around |x| = 0.25
+            float x = 0.5f - phase;
+            float a = std::abs(x);
+            float b = std::min(a, 0.5f - a);
+            float b2 = b * b;
+            float s;
+
+            if constexpr (accuracy == MathAccuracy::High)
+                s = b * (6.28318516f + b2 * (-41.341655f + b2 * (81.6010042f + b2 * (-76.5497843f + b2 * 39.5367193f))));
+            else
+                s = b * (6.28128016f + b2 * (-41.0952471f + b2 * 73.5855672f));
+
+            return std::copysign(s, x);
+        }
+    }
+
+    // Block versions, in place when dest == src
+    template <MathAccuracy accuracy>
+    inline void exp2(const float* src, float* dest, int numSamples)
+    {
+        if constexpr (accuracy == MathAccuracy::Exact)
+        {
+            for (int i = 0; i < numSamples; i++)
+                dest[i] = exp2<accuracy>(src[i]);
+        }
+        else
+        {
+            detail::clamp(src, dest, numSamples, -126.0f, 127.0f);
+            for (int i = 0; i < numSamples; i++)
+                dest[i] = detail::exp2Kernel<accuracy>(dest[i]);
+        }
+    }
+
+    template <MathAccuracy accuracy>
+    inline void tanh(const float* src, float* dest, int numSamples)
+    {
+        if constexpr (accuracy == MathAccuracy::Exact)
+        {
+            for (int i = 0; i < numSamples; i++)
+                dest[i] = tanh<accuracy>(src[i]);
+        }
+        else
+        {
+            detail::clamp(src, dest, numSamples, -detail::tanhLimit<accuracy>, detail::tanhLimit<accuracy>);
+            for (int i = 0; i < numSamples; i++)
+                dest[i] = detail::tanhKernel<accuracy>(dest[i]);
+        }
+    }
+
+    template <MathAccuracy accuracy>
+    inline void sin2Pi(const float* src, float* dest, int numSamples)
+    {
+        for (int i = 0; i < numSamples; i++)
+            dest[i] = sin2Pi<accuracy>(src[i]);
+    }
+}
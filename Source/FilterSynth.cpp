@@ -12,18 +12,20 @@
 #include "FilterSynth.h"
 
 FilterSynth::FilterSynth()
-: filterType(FilterType::LowPass), cutoff(10000.0f), resonance(0.7f) {} // Set the default parameters
+: lfoType(LFOType::Sine), oscType(OscType::Saw), filterType(FilterType::LowPass), cutoff(10000.0f), resonance(0.7f) {} // Set the default parameters
 
 FilterSynth::~FilterSynth() {};
 
 void FilterSynth::setSampleRate(float sr) {
     sampleRate = sr;
+    unison.setSampleRate(sr);
     setFilterCoeff(cutoff); // Update filter coefficients when sampleRate is changed
     }
     
 
-void FilterSynth::setOSC(OscType oscType, float freq, float phase) {
-    switch (oscType)
+void FilterSynth::setOSC(OscType _oscType, float freq, float phase) {
+    oscType = _oscType;
+    switch (_oscType)
     {
         case OscType::Saw:
             activeOsc = &Saw; // assign the pointer to the declared Saw object
@@ -34,10 +36,26 @@ void FilterSynth::setOSC(OscType oscType, float freq, float phase) {
         case OscType::Triangle:
             activeOsc = &Triangle;
             break;
+        case OscType::BlepSaw:
+            activeOsc = &BlepSaw;
+            break;
+        case OscType::BlepSquare:
+            activeOsc = &BlepSquare;
+            break;
+        case OscType::BlepPulse:
+            activeOsc = &BlepPulse;
+            break;
+        case OscType::BlampTriangle:
+            activeOsc = &BlampTriangle;
+            break;
     }
     activeOsc -> setFrequency(freq);
     activeOsc -> setPhase(phase);
     activeOsc -> setSampleRate(sampleRate);
+    
+    unison.setSampleRate(sampleRate);
+    unison.setFrequency(freq);
+    unison.reset(phase);
 }
 
 void FilterSynth::setLFO(LFOType _lfoType, float rate, float depth, float phase) {
@@ -62,58 +80,356 @@ void FilterSynth::setLFO(LFOType _lfoType, float rate, float depth, float phase)
     activeLFO -> setPhase(phase);
     activeLFO -> setGain(depth);
     activeLFO -> setSampleRate(sampleRate);
+    lfoDepth = depth;
+};
+
+void FilterSynth::setUnison(int numVoices, float detuneCents, float stereoWidth) {
+    unison.setNumVoices(numVoices);
+    unison.setDetune(detuneCents);
+    unison.setStereoWidth(stereoWidth);
+};
+
+void FilterSynth::setPulseWidth(float width, float modDepth) {
+    pulseWidth = width;
+    pulseWidthMod = modDepth;
+    BlepPulse.setPulseWidth(width);
+};
+
+float FilterSynth::getModulatedPulseWidth(float lfoSample) const {
+    if (lfoDepth == 0.0f)
+        return pulseWidth;
+    
+    return pulseWidth + pulseWidthMod * lfoSample / lfoDepth;
+}
+
+void FilterSynth::setWavetables(const WavetableSet* tables) {
+    Oscillator* oscillators[] = {&Saw, &Square, &Triangle, &BlepSaw, &BlepSquare, &BlepPulse, &BlampTriangle, &LFOSine, &LFOSaw, &LFOSquare, &LFOTriangle}; // no allocation, runs from applyConfig
+    for (auto* oscPtr : oscillators)
+    {
+        oscPtr -> setWavetables(tables);
+    }
+};
+
+void FilterSynth::setMathAccuracy(MathAccuracy accuracy) {
+    Oscillator* oscillators[] = {&Saw, &Square, &Triangle, &BlepSaw, &BlepSquare, &BlepPulse, &BlampTriangle, &LFOSine, &LFOSaw, &LFOSquare, &LFOTriangle};
+    for (auto* oscPtr : oscillators)
+    {
+        oscPtr -> setMathAccuracy(accuracy);
+    }
+};
+
+void FilterSynth::setFixedPointPhase(bool enabled) {
+    Oscillator* oscillators[] = {&Saw, &Square, &Triangle, &BlepSaw, &BlepSquare, &BlepPulse, &BlampTriangle, &LFOSine, &LFOSaw, &LFOSquare, &LFOTriangle};
+    for (auto* oscPtr : oscillators)
+    {
+        oscPtr -> setFixedPointPhase(enabled);
+    }
 };
 
 void FilterSynth::setFilter(FilterType _filterType, float fc, float _resonance) {
     filterType = _filterType;
     cutoff = fc;
     resonance = _resonance;
+    svf.setOutput(getSVFOutput(filterType));
+    svf.setResonance(resonance);
+    svfRight.setOutput(getSVFOutput(filterType));
+    svfRight.setResonance(resonance);
     setFilterCoeff(cutoff); // Update the filter coefficients when the filter setup is changed
 };
 
-void FilterSynth::setFilterCoeff(float modCutoff) {
+void FilterSynth::setCutoffModulation(const float* modulation) {
+    cutoffModulation = modulation;
+}
+
+float FilterSynth::getModCutoff(float lfoSample, int sample) const {
+    float fc = cutoff + lfoSample;
+    if (cutoffModulation != nullptr)
+        fc += cutoffModulation[sample];
+    
+    return juce::jlimit(20.0f, sampleRate/2.0f, fc);
+}
+
+juce::IIRCoefficients FilterSynth::makeCoefficients(float modCutoff) const {
     switch (filterType) {
         case FilterType::LowPass:
-            filter.setCoefficients(juce::IIRCoefficients::makeLowPass(sampleRate, modCutoff, resonance));
-            break;
+            return juce::IIRCoefficients::makeLowPass(sampleRate, modCutoff, resonance);
         case FilterType::HighPass:
-            filter.setCoefficients(juce::IIRCoefficients::makeHighPass(sampleRate, modCutoff, resonance));
-            break;
+            return juce::IIRCoefficients::makeHighPass(sampleRate, modCutoff, resonance);
         case FilterType::BandPass:
-            filter.setCoefficients(juce::IIRCoefficients::makeBandPass(sampleRate, modCutoff, resonance));
-            break;
+            return juce::IIRCoefficients::makeBandPass(sampleRate, modCutoff, resonance);
         case FilterType::AllPass:
-            filter.setCoefficients(juce::IIRCoefficients::makeAllPass(sampleRate, modCutoff, resonance));
-            break;
-            
+            return juce::IIRCoefficients::makeAllPass(sampleRate, modCutoff, resonance);
+        case FilterType::SVFLowPass:
+        case FilterType::SVFHighPass:
+        case FilterType::SVFBandPass:
+        case FilterType::SVFNotch:
+            break; // no biquad, see filterSample
+    }
+    return juce::IIRCoefficients::makeLowPass(sampleRate, modCutoff, resonance);
+};
+
+void FilterSynth::setFilterCoeff(float modCutoff) {
+    // jump straight to the new coefficients and cancel any running ramp
+    auto newCoeffs = makeCoefficients(modCutoff);
+    for (int k = 0; k < 5; k++)
+    {
+        coeffs[k] = newCoeffs.coefficients[k];
+        coeffSteps[k] = 0.0f;
     }
+    samplesUntilUpdate = 0;
+};
+
+void FilterSynth::setControlRate(int samplesPerUpdate) {
+    controlRate = juce::jmax(1, samplesPerUpdate);
+    samplesUntilUpdate = 0;
+};
+
+float FilterSynth::getCoeffUpdatesPerSecond() const {
+    return coeffUpdatesPerSecond;
 };
+
+float FilterSynth::filterSample(float input, float modCutoff) {
+    
+    // the state-variable filter takes the new cutoff every sample, no coefficients to design or ramp
+    if (isStateVariable(filterType))
+        return svf.process(input, tanLookup(modCutoff / sampleRate));
+    
+    advanceCoefficients(modCutoff);
+    return biquad(input, v1, v2);
+}
+
+void FilterSynth::filterStereo(float& left, float& right, float modCutoff) {
+    
+    if (isStateVariable(filterType))
+    {
+        float g = tanLookup(modCutoff / sampleRate);
+        left = svf.process(left, g);
+        right = svfRight.process(right, g);
+        return;
+    }
+    
+    advanceCoefficients(modCutoff);
+    left = biquad(left, v1, v2);
+    right = biquad(right, v1Right, v2Right);
+}
+
+void FilterSynth::advanceCoefficients(float modCutoff) {
+    
+    if (samplesUntilUpdate <= 0)
+    {
+        auto target = makeCoefficients(modCutoff);
+        coeffUpdateCount++;
+        
+        if (controlRate == 1)
+        {
+            for (int k = 0; k < 5; k++)
+                coeffs[k] = target.coefficients[k];
+        }
+        else
+        {
+            // ramp linearly towards the new coefficients over the next control period
+            for (int k = 0; k < 5; k++)
+                coeffSteps[k] = (target.coefficients[k] - coeffs[k]) / controlRate;
+        }
+        samplesUntilUpdate = controlRate;
+    }
+    
+    if (controlRate > 1)
+    {
+        for (int k = 0; k < 5; k++)
+            coeffs[k] += coeffSteps[k];
+    }
+    samplesUntilUpdate--;
+}
+
+float FilterSynth::biquad(float input, float& s1, float& s2) const {
+    
+    // y[n] = b0*x[n] + s1, same structure as juce::IIRFilter::processSingleSampleRaw
+    float output = coeffs[0] * input + s1;
+    s1 = coeffs[1] * input - coeffs[3] * output + s2;
+    s2 = coeffs[2] * input - coeffs[4] * output;
+    JUCE_SNAP_TO_ZERO(s1);
+    JUCE_SNAP_TO_ZERO(s2);
+    
+    return output;
+}
     
 float FilterSynth::process(bool expLFO) {
     
     if (activeOsc == nullptr || activeLFO == nullptr)  // Ensure both are selected
          return 0.0f;
     
-    // Generate oscillator and LFO samples (single)
-    float oscSample = activeOsc -> process(); // dereferences the pointer and accesses the method
+    // Generate LFO and oscillator samples (single), the LFO first as it may move the pulse width
+    // if LFO is a Saw waveform, then do exponential rampping, the phase advances once either way
+    float lfoSample = (lfoType == LFOType::Saw) ? LFOSaw.process(expLFO) : activeLFO -> process();
     
-    float lfoSample;
-    // if LFO is a Saw waveform, then do exponential rampping
-    if (lfoType == LFOType::Saw) {
-        sawOSC* sawLFO = dynamic_cast<sawOSC*>(activeLFO);
-        if (sawLFO) {
-            lfoSample = sawLFO -> process(expLFO);
-        }
-    }
-    lfoSample = activeLFO -> process();
+    if (oscType == OscType::BlepPulse)
+        BlepPulse.setPulseWidth(getModulatedPulseWidth(lfoSample));
+    
+    float oscSample;
+    if (unison.getNumVoices() > 1)
+        unison.process(&oscSample, 1);
+    else
+        oscSample = activeOsc -> process(); // dereferences the pointer and accesses the method
     
     // Modulate filter cutoff with LFO
     float modCutoff = juce::jlimit(20.0f, sampleRate/2.0f, cutoff + lfoSample);
-   
-    setFilterCoeff(modCutoff);
     
-    // Filter the current audio sample
-    return filter.processSingleSampleRaw(oscSample);
+    // Filter the current audio sample, the coefficients follow at the control rate
+    return filterSample(oscSample, modCutoff);
+    
+}
+    
+
+void FilterSynth::process(float* dest, int numSamples, bool expLFO) {
+    
+    if (activeOsc == nullptr || activeLFO == nullptr)  // Ensure both are selected
+    {
+        std::fill(dest, dest + numSamples, 0.0f);
+        return;
+    }
+    
+    coeffUpdateCount = 0;
+    
+    // pick the oscillator once per block
+    if (unison.getNumVoices() > 1)
+        processUnison(dest, nullptr, numSamples, expLFO);
+    else switch (oscType)
+    {
+        case OscType::Saw:
+            processWithOsc(Saw, dest, numSamples, expLFO);
+            break;
+        case OscType::Square:
+            processWithOsc(Square, dest, numSamples, expLFO);
+            break;
+        case OscType::Triangle:
+            processWithOsc(Triangle, dest, numSamples, expLFO);
+            break;
+        case OscType::BlepSaw:
+            processWithOsc(BlepSaw, dest, numSamples, expLFO);
+            break;
+        case OscType::BlepSquare:
+            processWithOsc(BlepSquare, dest, numSamples, expLFO);
+            break;
+        case OscType::BlepPulse:
+            processWithOsc(BlepPulse, dest, numSamples, expLFO);
+            break;
+        case OscType::BlampTriangle:
+            processWithOsc(BlampTriangle, dest, numSamples, expLFO);
+            break;
+    }
+    
+    if (numSamples > 0)
+        coeffUpdatesPerSecond = coeffUpdateCount * sampleRate / numSamples;
+}
+
+void FilterSynth::process(float* left, float* right, int numSamples, bool expLFO) {
+    
+    // without unison the voice is mono, both channels get the same signal
+    if (activeOsc == nullptr || activeLFO == nullptr || unison.getNumVoices() <= 1)
+    {
+        process(left, numSamples, expLFO);
+        std::copy(left, left + numSamples, right);
+        return;
+    }
+    
+    coeffUpdateCount = 0;
+    processUnison(left, right, numSamples, expLFO);
+    
+    if (numSamples > 0)
+        coeffUpdatesPerSecond = coeffUpdateCount * sampleRate / numSamples;
+}
+
+void FilterSynth::processUnison(float* left, float* right, int numSamples, bool expLFO) {
+    
+    for (int start = 0; start < numSamples; start += maxChunkSize)
+    {
+        int n = juce::jmin(maxChunkSize, numSamples - start);
+        float* outLeft = left + start;
+        
+        // the LFO only sweeps the cutoff here, one virtual call per chunk
+        if (lfoType == LFOType::Saw)
+            LFOSaw.process(lfoBuffer, n, expLFO);
+        else
+            activeLFO -> process(lfoBuffer, n);
+        
+        if (right == nullptr)
+        {
+            unison.process(outLeft, n);
+            
+            for (int i = 0; i < n; i++)
+                outLeft[i] = filterSample(outLeft[i], getModCutoff(lfoBuffer[i], start + i));
+        }
+        else
+        {
+            float* outRight = right + start;
+            unison.process(outLeft, outRight, n);
+            
+            for (int i = 0; i < n; i++)
+                filterStereo(outLeft[i], outRight[i], getModCutoff(lfoBuffer[i], start + i));
+        }
+    }
+}
+
+template <typename OscT>
+void FilterSynth::processWithOsc(OscT& osc, float* dest, int numSamples, bool expLFO) {
     
+    // and the LFO
+    switch (lfoType)
+    {
+        case LFOType::Sine:
+            processWith(osc, LFOSine, dest, numSamples, expLFO);
+            break;
+        case LFOType::Saw:
+            processWith(osc, LFOSaw, dest, numSamples, expLFO);
+            break;
+        case LFOType::Square:
+            processWith(osc, LFOSquare, dest, numSamples, expLFO);
+            break;
+        case LFOType::Triangle:
+            processWith(osc, LFOTriangle, dest, numSamples, expLFO);
+            break;
+    }
 }
+
+template <typename OscT, typename LFOT>
+void FilterSynth::processWith(OscT& osc, LFOT& lfo, float* dest, int numSamples, bool expLFO) {
     
+    for (int start = 0; start < numSamples; start += maxChunkSize)
+    {
+        int n = juce::jmin(maxChunkSize, numSamples - start);
+        float* out = dest + start;
+        
+        // Generate the LFO and oscillator blocks, the types are known so there is no virtual call
+        if constexpr (std::is_same<LFOT, sawOSC>::value)
+            lfo.process(lfoBuffer, n, expLFO); // exponential ramping for the saw LFO
+        else
+            lfo.process(lfoBuffer, n);
+        
+        if constexpr (std::is_same<OscT, blepPulseOSC>::value)
+        {
+            // BlepPulse follows the LFO, BlepSquare keeps its width of 0.5
+            if (oscType == OscType::BlepPulse)
+            {
+                for (int i = 0; i < n; i++)
+                    pulseWidthBuffer[i] = getModulatedPulseWidth(lfoBuffer[i]);
+                
+                osc.process(out, n, pulseWidthBuffer);
+            }
+            else
+            {
+                osc.process(out, n);
+            }
+        }
+        else
+        {
+            osc.process(out, n);
+        }
+        
+        for (int i = 0; i < n; i++)
+        {
+            // Modulate filter cutoff with LFO and the modulation matrix
+            out[i] = filterSample(out[i], getModCutoff(lfoBuffer[i], start + i));
+        }
+    }
+}
@@ -12,18 +12,46 @@
 #pragma once
 #include <JuceHeader.h>
 #include "Oscillator.h"
+#include "SVFilter.h"
+#include "UnisonOscillator.h"
 
 enum class FilterType {
     LowPass,
     HighPass,
     BandPass,
-    AllPass
+    AllPass,
+    SVFLowPass,  // state-variable (TPT), the cutoff follows the LFO every sample
+    SVFHighPass,
+    SVFBandPass,
+    SVFNotch
 };
 
+inline bool isStateVariable(FilterType type)
+{
+    return type == FilterType::SVFLowPass || type == FilterType::SVFHighPass
+        || type == FilterType::SVFBandPass || type == FilterType::SVFNotch;
+}
+
+inline SVFOutput getSVFOutput(FilterType type)
+{
+    switch (type)
+    {
+        case FilterType::SVFHighPass: return SVFOutput::HighPass;
+        case FilterType::SVFBandPass: return SVFOutput::BandPass;
+        case FilterType::SVFNotch:    return SVFOutput::Notch;
+        default:                      break;
+    }
+    return SVFOutput::LowPass;
+}
+
 enum class OscType {
     Saw,
     Square,
-    Triangle
+    Triangle,
+    BlepSaw,      // PolyBLEP, computed per sample, never reads the wavetables
+    BlepSquare,
+    BlepPulse,    // pulse width and LFO pulse-width modulation set with setPulseWidth
+    BlampTriangle // PolyBLAMP
 };
 
 enum class LFOType {
@@ -44,8 +72,22 @@ public:
     void setLFO(LFOType lfoType, float rate, float depth, float phase); // set LFO to modulate the cutoff frequency
     void setFilter(FilterType _filterType, float _fc, float _resonance); // set filter arguments
     void setFilterCoeff(float modCutoff); // set the filter coefficients corresponding to the arguments
+    void setWavetables(const WavetableSet* tables); // oscillators and LFOs read baked tables, nullptr to compute the waveshapes
+    void setMathAccuracy(MathAccuracy accuracy); // how the oscillators and LFOs compute their waveshapes without tables
+    void setFixedPointPhase(bool enabled); // drift-free phase accumulators for the oscillators and LFOs
+    void setPulseWidth(float width, float modDepth); // BlepPulse width 0 ~ 1, the LFO swings it by +-modDepth
+    void setControlRate(int samplesPerUpdate); // recompute the coefficients every N samples and interpolate in between (1 = every sample)
+    void setCutoffModulation(const float* modulation); // Hz added to the cutoff per sample of the next block process, nullptr for none
+    float getCoeffUpdatesPerSecond() const; // biquad coefficient updates per second measured over the last block, 0 for the SVF types
+    
+    // Unison: a stack of detuned PolyBLEP saws in place of the selected oscillator, 1 voice turns it off.
+    // The voices are rendered side by side in SIMD lanes, see UnisonOscillator
+    void setUnison(int numVoices, float detuneCents, float stereoWidth);
+    int getUnisonVoices() const { return unison.getNumVoices(); }
     
     float process(bool expLFO); //Generate a sample
+    void process(float* dest, int numSamples, bool expLFO); // Generate a block of samples
+    void process(float* left, float* right, int numSamples, bool expLFO); // Stereo block, only unison spreads across the channels
     
 private:
     // Instantiate the Ocillator objects
@@ -53,6 +95,10 @@ private:
     sawOSC Saw;
     squareOSC Square;
     triangleOSC Triangle;
+    blepSawOSC BlepSaw;
+    blepPulseOSC BlepSquare;
+    blepPulseOSC BlepPulse;
+    blampTriangleOSC BlampTriangle;
     
     sineOSC LFOSine;
     sawOSC LFOSaw;
@@ -61,16 +107,61 @@ private:
     LFOType lfoType;
 //    bool expLFO;
     
+    OscType oscType;
+    
+    // Pulse-width modulation, the LFO output is scaled back to -1 ~ 1 by its depth
+    float pulseWidth = 0.5f;
+    float pulseWidthMod = 0.0f;
+    float lfoDepth = 0.0f;
+    float getModulatedPulseWidth(float lfoSample) const;
+    
     Oscillator* activeOsc = nullptr; // Pointer to the selected oscillator
     Oscillator* activeLFO = nullptr; // Pointer to the selected LFO
     
+    // Block rendering resolved at compile time: the switch on the oscillator and
+    // LFO types runs once per block, the loops see the concrete (final) classes
+    template <typename OscT>
+    void processWithOsc(OscT& osc, float* dest, int numSamples, bool expLFO);
+    template <typename OscT, typename LFOT>
+    void processWith(OscT& osc, LFOT& lfo, float* dest, int numSamples, bool expLFO);
+    void processUnison(float* left, float* right, int numSamples, bool expLFO); // mono when right is nullptr
+    
+    UnisonOscillator unison;
+    
     // Set the filter and its parameters
     
-    juce::IIRFilter filter;
+    juce::IIRCoefficients makeCoefficients(float modCutoff) const;
+    float filterSample(float input, float modCutoff); // advance the coefficient ramp and filter one sample
+    void filterStereo(float& left, float& right, float modCutoff); // both channels through the same coefficients
+    void advanceCoefficients(float modCutoff); // the control-rate update and ramp, once per sample
+    float biquad(float input, float& s1, float& s2) const;
+    
     FilterType filterType;
+    const float* cutoffModulation = nullptr;
+    float getModCutoff(float lfoSample, int sample) const; // the cutoff with the LFO and the modulation, clamped
+    SVFilter svf; // used instead of the biquad for the SVF types, modulated per sample
+    SVFilter svfRight; // the right channel of the stereo process
+    const TanLookup& tanLookup = TanLookup::get();
     float sampleRate;
     float cutoff;
     float resonance;
+    
+    // Transposed direct form II biquad, kept here so its coefficients can be ramped
+    float coeffs[5] = { 1.0f, 0.0f, 0.0f, 0.0f, 0.0f }; // b0, b1, b2, a1, a2 (normalised)
+    float coeffSteps[5] = {};
+    float v1 = 0.0f, v2 = 0.0f;
+    float v1Right = 0.0f, v2Right = 0.0f;
+    
+    // Control-rate coefficient updates
+    int controlRate = 1;
+    int samplesUntilUpdate = 0;
+    int coeffUpdateCount = 0;
+    float coeffUpdatesPerSecond = 0.0f;
+    
+    // Scratch space for block rendering, blocks larger than this are split into chunks
+    static constexpr int maxChunkSize = 256;
+    float lfoBuffer[maxChunkSize];
+    float pulseWidthBuffer[maxChunkSize];
 
     // Other objects and parameters
     
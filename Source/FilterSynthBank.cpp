@@ -0,0 +1,809 @@
+/*
+  ==============================================================================
+
+    FilterSynthBank.cpp
+    A bank of FilterSynth-equivalent voices stored structure-of-arrays, so the
+    oscillator phases, LFOs and biquads of several voices run in SIMD lanes.
+    Created: 17 Oct 2026 10:12:41am
+    Author:  chenzuyu
+
+  ==============================================================================
+*/
+
+#include "FilterSynthBank.h"
+
+namespace
+{
+    using Vec = FilterSynthBank::Vec;
+
+    bool isPolyBlep(OscType type)
+    {
+        return type == OscType::BlepSaw || type == OscType::BlepSquare
+            || type == OscType::BlepPulse || type == OscType::BlampTriangle;
+    }
+
+    // 1 / phaseDelta per lane, 0 for a lane that does not move
+    Vec getInverse(const Vec& delta)
+    {
+        Vec inverse;
+        for (size_t lane = 0; lane < Vec::SIMDNumElements; lane++)
+            inverse.set(lane, delta.get(lane) > 0.0f ? 1.0f / delta.get(lane) : 0.0f);
+
+        return inverse;
+    }
+
+    // polyBlep and polyBlamp from Oscillator.cpp on whole registers,
+    // the two branches become lane masks
+    Vec polyBlep(Vec t, Vec dt, Vec inverseDt)
+    {
+        const auto one = Vec::expand(1.0f);
+        auto a = t * inverseDt;
+        auto rising = a + a - a * a - one;
+        auto b = (t - one) * inverseDt;
+        auto falling = b * b + b + b + one;
+        return (rising & Vec::lessThan(t, dt)) + (falling & Vec::greaterThan(t, one - dt));
+    }
+
+    Vec polyBlamp(Vec t, Vec dt, Vec inverseDt)
+    {
+        const auto one = Vec::expand(1.0f);
+        const auto third = Vec::expand(1.0f / 3.0f);
+        auto a = t * inverseDt - one;
+        auto rising = (Vec::expand(0.0f) - a * a * a) * third;
+        auto b = (t - one) * inverseDt + one;
+        auto falling = b * b * b * third;
+        return (rising & Vec::lessThan(t, dt)) + (falling & Vec::greaterThan(t, one - dt));
+    }
+
+    Vec wrapPhase(Vec p)
+    {
+        const auto one = Vec::expand(1.0f);
+        return p - (one & Vec::greaterThanOrEqual(p, one));
+    }
+
+    // blepPulseOSC::shape, width per lane
+    Vec blepPulse(Vec p, Vec dt, Vec inverseDt, Vec width)
+    {
+        const auto one = Vec::expand(1.0f);
+        auto output = (Vec::expand(2.0f) & Vec::lessThan(p, width)) - one;
+        return output + polyBlep(p, dt, inverseDt) - polyBlep(wrapPhase(p + one - width), dt, inverseDt);
+    }
+}
+
+FilterSynthBank::FilterSynthBank()
+{
+    for (int v = 0; v < maxVoices; v++)
+    {
+        oscTypes[v] = OscType::Saw;
+        lfoTypes[v] = LFOType::Sine;
+        expLFO[v] = false;
+        filterTypes[v] = FilterType::LowPass;
+        oscFrequency[v] = 0.0f;
+        lfoRate[v] = 0.0f;
+        resonance[v] = 0.7f;
+        pulseWidth[v] = 0.5f;
+        pulseWidthMod[v] = 0.0f;
+    }
+
+    for (int g = 0; g < maxGroups; g++)
+    {
+        oscPhase[g] = Vec::expand(0.0f);
+        oscDelta[g] = Vec::expand(0.0f);
+        lfoPhase[g] = Vec::expand(0.0f);
+        lfoDelta[g] = Vec::expand(0.0f);
+        lfoDepth[g] = Vec::expand(0.0f);
+        cutoff[g] = Vec::expand(10000.0f);
+        v1[g] = Vec::expand(0.0f);
+        v2[g] = Vec::expand(0.0f);
+        svf1[g] = Vec::expand(0.0f);
+        svf2[g] = Vec::expand(0.0f);
+
+        for (int k = 0; k < 5; k++)
+        {
+            coeffs[g][k] = Vec::expand(k == 0 ? 1.0f : 0.0f); // pass-through until a filter is set
+            coeffSteps[g][k] = Vec::expand(0.0f);
+        }
+    }
+}
+
+void FilterSynthBank::setSampleRate(float sr)
+{
+    sampleRate = sr;
+
+    // the phase increments depend on the sample rate
+    for (int v = 0; v < maxVoices; v++)
+    {
+        setLane(oscDelta[v / lanes], v % lanes, oscFrequency[v] / sampleRate);
+        setLane(lfoDelta[v / lanes], v % lanes, lfoRate[v] / sampleRate);
+        unison[v].setSampleRate(sampleRate);
+    }
+
+    for (int g = 0; g < maxGroups; g++)
+        samplesUntilUpdate[g] = 0;
+}
+
+void FilterSynthBank::setNumVoices(int n)
+{
+    numVoices = juce::jlimit(0, maxVoices, n);
+    numGroups = (numVoices + lanes - 1) / lanes;
+}
+
+void FilterSynthBank::setOSC(int voice, OscType oscType, float frequency, float phase)
+{
+    jassert(voice >= 0 && voice < maxVoices);
+    oscTypes[voice] = oscType;
+    oscFrequency[voice] = frequency;
+    setLane(oscDelta[voice / lanes], voice % lanes, frequency / sampleRate);
+    setLane(oscPhase[voice / lanes], voice % lanes, phase);
+
+    unison[voice].setFrequency(frequency);
+    unison[voice].reset(phase);
+}
+
+void FilterSynthBank::setLFO(int voice, LFOType lfoType, float rate, float depth, float phase)
+{
+    jassert(voice >= 0 && voice < maxVoices);
+    lfoTypes[voice] = lfoType;
+    lfoRate[voice] = rate;
+    setLane(lfoDelta[voice / lanes], voice % lanes, rate / sampleRate);
+    setLane(lfoPhase[voice / lanes], voice % lanes, phase);
+    setLane(lfoDepth[voice / lanes], voice % lanes, depth);
+}
+
+void FilterSynthBank::setExponentialLFO(int voice, bool exponential)
+{
+    jassert(voice >= 0 && voice < maxVoices);
+    expLFO[voice] = exponential;
+}
+
+void FilterSynthBank::setFilter(int voice, FilterType filterType, float fc, float _resonance)
+{
+    jassert(voice >= 0 && voice < maxVoices);
+    filterTypes[voice] = filterType;
+    resonance[voice] = _resonance;
+    setLane(cutoff[voice / lanes], voice % lanes, fc);
+
+    // jump straight to the new coefficients, as FilterSynth::setFilter does
+    auto newCoeffs = makeCoefficients(voice, fc);
+    for (int k = 0; k < 5; k++)
+    {
+        setLane(coeffs[voice / lanes][k], voice % lanes, newCoeffs.coefficients[k]);
+        setLane(coeffSteps[voice / lanes][k], voice % lanes, 0.0f);
+    }
+}
+
+void FilterSynthBank::setPulseWidth(int voice, float width, float modDepth)
+{
+    jassert(voice >= 0 && voice < maxVoices);
+    pulseWidth[voice] = width;
+    pulseWidthMod[voice] = modDepth;
+}
+
+void FilterSynthBank::setUnison(int voice, int numUnisonVoices, float detuneCents, float stereoWidth)
+{
+    jassert(voice >= 0 && voice < maxVoices);
+    auto& stack = unison[voice];
+    stack.setFrequency(oscFrequency[voice]); // only followed while the stack is on
+    stack.setNumVoices(numUnisonVoices);
+    stack.setDetune(detuneCents);
+    stack.setStereoWidth(stereoWidth);
+}
+
+void FilterSynthBank::setOSCType(int voice, OscType oscType)
+{
+    oscTypes[voice] = oscType;
+}
+
+void FilterSynthBank::setOSCFrequency(int voice, float frequency)
+{
+    oscFrequency[voice] = frequency;
+    setLane(oscDelta[voice / lanes], voice % lanes, frequency / sampleRate);
+
+    // the stack recomputes its increments and gains, only worth it while it plays
+    if (isUnison(voice))
+        unison[voice].setFrequency(frequency);
+}
+
+void FilterSynthBank::setLFOType(int voice, LFOType lfoType)
+{
+    lfoTypes[voice] = lfoType;
+}
+
+void FilterSynthBank::setLFORate(int voice, float rate)
+{
+    lfoRate[voice] = rate;
+    setLane(lfoDelta[voice / lanes], voice % lanes, rate / sampleRate);
+}
+
+void FilterSynthBank::setLFODepth(int voice, float depth)
+{
+    setLane(lfoDepth[voice / lanes], voice % lanes, depth);
+}
+
+void FilterSynthBank::setFilterType(int voice, FilterType filterType)
+{
+    filterTypes[voice] = filterType;
+}
+
+void FilterSynthBank::setCutoff(int voice, float fc)
+{
+    setLane(cutoff[voice / lanes], voice % lanes, fc);
+}
+
+void FilterSynthBank::setResonance(int voice, float _resonance)
+{
+    resonance[voice] = _resonance;
+}
+
+void FilterSynthBank::setWavetables(const WavetableSet* tables)
+{
+    wavetables = tables;
+}
+
+void FilterSynthBank::setMathAccuracy(MathAccuracy accuracy)
+{
+    mathAccuracy = accuracy;
+}
+
+void FilterSynthBank::setControlRate(int samplesPerUpdate)
+{
+    controlRate = juce::jmax(1, samplesPerUpdate);
+
+    for (int g = 0; g < maxGroups; g++)
+        samplesUntilUpdate[g] = 0;
+}
+
+float FilterSynthBank::getCoeffUpdatesPerSecond() const
+{
+    float total = 0.0f;
+    for (int g = 0; g < numGroups; g++)
+        total += coeffUpdatesPerSecond[g];
+
+    return total;
+}
+
+juce::IIRCoefficients FilterSynthBank::makeCoefficients(int voice, float modCutoff) const
+{
+    switch (filterTypes[voice]) {
+        case FilterType::LowPass:
+            return juce::IIRCoefficients::makeLowPass(sampleRate, modCutoff, resonance[voice]);
+        case FilterType::HighPass:
+            return juce::IIRCoefficients::makeHighPass(sampleRate, modCutoff, resonance[voice]);
+        case FilterType::BandPass:
+            return juce::IIRCoefficients::makeBandPass(sampleRate, modCutoff, resonance[voice]);
+        case FilterType::AllPass:
+            return juce::IIRCoefficients::makeAllPass(sampleRate, modCutoff, resonance[voice]);
+        case FilterType::SVFLowPass:
+        case FilterType::SVFHighPass:
+        case FilterType::SVFBandPass:
+        case FilterType::SVFNotch:
+            break; // no biquad, see processChunk
+    }
+    return juce::IIRCoefficients::makeLowPass(sampleRate, modCutoff, resonance[voice]);
+}
+
+const Wavetable& FilterSynthBank::getOscTable(int voice) const
+{
+    switch (oscTypes[voice])
+    {
+        case OscType::Saw:
+            return wavetables -> saw;
+        case OscType::Square:
+            return wavetables -> square;
+        case OscType::Triangle:
+            return wavetables -> triangle;
+        case OscType::BlepSaw:
+        case OscType::BlepSquare:
+        case OscType::BlepPulse:
+        case OscType::BlampTriangle:
+            break; // computed, see shapeOscillator
+    }
+    return wavetables -> saw;
+}
+
+const Wavetable& FilterSynthBank::getLFOTable(int voice) const
+{
+    switch (lfoTypes[voice])
+    {
+        case LFOType::Sine:
+            return wavetables -> sine;
+        case LFOType::Saw:
+            return expLFO[voice] ? wavetables -> sawExponential : wavetables -> saw;
+        case LFOType::Square:
+            return wavetables -> square;
+        case LFOType::Triangle:
+            return wavetables -> triangle;
+    }
+    return wavetables -> sine;
+}
+
+void FilterSynthBank::setCutoffModulation(const float* modulation, int log2SamplesPerValue)
+{
+    cutoffModulation = modulation;
+    cutoffModulationShift = log2SamplesPerValue;
+}
+
+void FilterSynthBank::process(float* const* dest, int numSamples)
+{
+    for (int g = 0; g < numGroups; g++)
+        processGroup(g, dest, numSamples);
+}
+
+void FilterSynthBank::processGroup(int group, float* const* dest, int numSamples)
+{
+    coeffUpdateCount[group] = 0;
+
+    for (int start = 0; start < numSamples; start += maxChunkSize)
+        processChunk(group, dest, start, juce::jmin(maxChunkSize, numSamples - start));
+
+    if (numSamples > 0)
+        coeffUpdatesPerSecond[group] = coeffUpdateCount[group] * sampleRate / numSamples;
+}
+
+void FilterSynthBank::updateCoefficients(int group, const Vec& modCutoff)
+{
+    // the coefficient design is scalar, everything around it runs on whole registers
+    Vec target[5];
+    for (int k = 0; k < 5; k++)
+        target[k] = coeffs[group][k];
+
+    for (int lane = 0; lane < lanes; lane++)
+    {
+        int voice = group * lanes + lane;
+        if (voice >= numVoices)
+            break;
+
+        // lanes on the state-variable filter pass through the biquad untouched
+        if (isStateVariable(filterTypes[voice]))
+        {
+            for (int k = 0; k < 5; k++)
+                setLane(target[k], lane, k == 0 ? 1.0f : 0.0f);
+            continue;
+        }
+
+        auto c = makeCoefficients(voice, getLane(modCutoff, lane));
+        for (int k = 0; k < 5; k++)
+            setLane(target[k], lane, c.coefficients[k]);
+
+        coeffUpdateCount[group]++;
+    }
+
+    if (controlRate == 1)
+    {
+        for (int k = 0; k < 5; k++)
+            coeffs[group][k] = target[k];
+    }
+    else
+    {
+        // ramp linearly towards the new coefficients over the next control period
+        auto scale = Vec::expand(1.0f / controlRate);
+        for (int k = 0; k < 5; k++)
+            coeffSteps[group][k] = (target[k] - coeffs[group][k]) * scale;
+    }
+}
+
+void FilterSynthBank::processChunk(int group, float* const* dest, int startSample, int numSamples)
+{
+    const auto one = Vec::expand(1.0f);
+    float* oscBuffer = this->oscBuffer[group];
+    float* lfoBuffer = this->lfoBuffer[group];
+
+    // 1. Advance the oscillator and LFO phases of all lanes together
+    auto oscP = oscPhase[group];
+    auto lfoP = lfoPhase[group];
+    const auto oscD = oscDelta[group];
+    const auto lfoD = lfoDelta[group];
+
+    for (int i = 0; i < numSamples; i++)
+    {
+        oscP.copyToRawArray(oscBuffer + i * lanes);
+        lfoP.copyToRawArray(lfoBuffer + i * lanes);
+
+        oscP += oscD;
+        lfoP += lfoD;
+
+        // phase wrapping without branches
+        oscP -= one & Vec::greaterThan(oscP, one);
+        lfoP -= one & Vec::greaterThan(lfoP, one);
+    }
+
+    oscPhase[group] = oscP;
+    lfoPhase[group] = lfoP;
+
+    // 2. Shape the waveforms. The LFO goes first, a pulse oscillator reads it for its pulse width
+    shapeLFOs(group, lfoBuffer, numSamples);
+    shapeOscillators(group, oscBuffer, lfoBuffer, numSamples);
+    renderUnison(group, oscBuffer, numSamples);
+
+    // 3. LFO-modulated filters, all lanes per instruction. A lane runs either the
+    // biquad or the state-variable filter, a group only runs the ones its lanes use
+    const auto depth = lfoDepth[group];
+    const auto fc = cutoff[group];
+    const float* fcMod = cutoffModulation;
+    const auto minCutoff = Vec::expand(20.0f);
+    const auto maxCutoff = Vec::expand(sampleRate / 2.0f);
+
+    bool hasBiquad = false, hasSVF = false;
+    auto svfSelect = Vec::expand(0.0f); // 1 in the lanes on the SVF
+    auto damping = Vec::expand(1.0f);
+    Vec mix[3] = { Vec::expand(0.0f), Vec::expand(0.0f), Vec::expand(0.0f) }; // y = m0*x + m1*bandPass + m2*lowPass
+
+    for (int lane = 0; lane < lanes; lane++)
+    {
+        int voice = group * lanes + lane;
+        if (voice >= numVoices)
+            break;
+
+        if (! isStateVariable(filterTypes[voice]))
+        {
+            hasBiquad = true;
+            continue;
+        }
+
+        hasSVF = true;
+        float k = SVFilter::getDamping(resonance[voice]);
+        float m0, m1, m2;
+        SVFilter::getOutputMix(getSVFOutput(filterTypes[voice]), k, m0, m1, m2);
+
+        setLane(svfSelect, lane, 1.0f);
+        setLane(damping, lane, k);
+        setLane(mix[0], lane, m0);
+        setLane(mix[1], lane, m1);
+        setLane(mix[2], lane, m2);
+    }
+
+    // the voice's own cutoff plus the shared modulation, if any
+    auto getCutoff = [&] (int i)
+    {
+        return fcMod != nullptr ? fc + Vec::expand(fcMod[(startSample + i) >> cutoffModulationShift]) : fc;
+    };
+
+    auto s1 = v1[group];
+    auto s2 = v2[group];
+    auto ic1 = svf1[group];
+    auto ic2 = svf2[group];
+
+    for (int i = 0; i < numSamples; i++)
+    {
+        auto input = Vec::fromRawArray(oscBuffer + i * lanes);
+        auto lfo = Vec::fromRawArray(lfoBuffer + i * lanes);
+        auto output = input;
+
+        if (hasBiquad)
+        {
+            if (samplesUntilUpdate[group] <= 0)
+            {
+                // Modulate filter cutoff with LFO
+                auto modCutoff = Vec::min(maxCutoff, Vec::max(minCutoff, getCutoff(i) + lfo * depth));
+                updateCoefficients(group, modCutoff);
+                samplesUntilUpdate[group] = controlRate;
+            }
+
+            auto* c = coeffs[group];
+            if (controlRate > 1)
+            {
+                for (int k = 0; k < 5; k++)
+                    c[k] += coeffSteps[group][k];
+            }
+            samplesUntilUpdate[group]--;
+
+            // Transposed direct form II, as in FilterSynth
+            output = c[0] * input + s1;
+            s1 = c[1] * input - c[3] * output + s2;
+            s2 = c[2] * input - c[4] * output;
+        }
+
+        if (hasSVF)
+        {
+            // the cutoff follows the LFO every sample, only the tan and the
+            // reciprocal are per lane, the rest is as in SVFilter
+            auto modCutoff = Vec::min(maxCutoff, Vec::max(minCutoff, getCutoff(i) + lfo * depth));
+            Vec g, a1;
+            for (int lane = 0; lane < lanes; lane++)
+            {
+                float gLane = tanLookup(getLane(modCutoff, lane) / sampleRate);
+                setLane(g, lane, gLane);
+                setLane(a1, lane, 1.0f / (1.0f + gLane * (gLane + getLane(damping, lane))));
+            }
+            auto a2 = g * a1;
+            auto a3 = g * a2;
+
+            auto v3 = input - ic2;
+            auto bandPass = a1 * ic1 + a2 * v3;
+            auto lowPass = ic2 + a2 * ic1 + a3 * v3;
+            ic1 = bandPass * 2.0f - ic1;
+            ic2 = lowPass * 2.0f - ic2;
+
+            auto svfOutput = mix[0] * input + mix[1] * bandPass + mix[2] * lowPass;
+            output = hasBiquad ? output + svfSelect * (svfOutput - output) : svfOutput;
+        }
+
+        output.copyToRawArray(oscBuffer + i * lanes);
+    }
+
+    v1[group] = s1;
+    v2[group] = s2;
+    svf1[group] = ic1;
+    svf2[group] = ic2;
+
+    // 4. Hand each lane back to its own channel
+    for (int lane = 0; lane < lanes; lane++)
+    {
+        int voice = group * lanes + lane;
+        if (voice >= numVoices)
+            break;
+
+        float* out = dest[voice] + startSample;
+        for (int i = 0; i < numSamples; i++)
+            out[i] = oscBuffer[i * lanes + lane];
+    }
+}
+
+void FilterSynthBank::shapeLFOs(int group, float* lfoBuffer, int numSamples) const
+{
+    const int first = group * lanes;
+    const int activeLanes = juce::jmin(lanes, numVoices - first);
+    const int count = numSamples * lanes;
+
+    bool shared = true;
+    for (int lane = 1; lane < activeLanes; lane++)
+        shared = shared && lfoTypes[first + lane] == lfoTypes[first];
+
+    // table reads are gathers, they stay one lane at a time
+    if (wavetables != nullptr || ! shared)
+    {
+        for (int lane = 0; lane < activeLanes; lane++)
+            shapeLFOLane(first + lane, lane, lfoBuffer, getLane(lfoDelta[group], lane), numSamples);
+        return;
+    }
+
+    // one pass over the whole chunk, the unused lanes of the last group come along
+    switch (lfoTypes[first])
+    {
+        case LFOType::Sine:
+            sineOSC::shape(lfoBuffer, count, mathAccuracy);
+            break;
+        case LFOType::Saw:
+        {
+            // the exponential ramp is a per lane flag, mixed flags go lane by lane
+            bool exponential = expLFO[first];
+            for (int lane = 1; lane < activeLanes; lane++)
+            {
+                if (expLFO[first + lane] != exponential)
+                {
+                    for (int l = 0; l < activeLanes; l++)
+                        shapeLFOLane(first + l, l, lfoBuffer, getLane(lfoDelta[group], l), numSamples);
+                    return;
+                }
+            }
+
+            if (exponential)
+                sawOSC::shapeExponential(lfoBuffer, count, mathAccuracy);
+            else
+                sawOSC::shape(lfoBuffer, count, mathAccuracy);
+            break;
+        }
+        case LFOType::Square:
+            squareOSC::shape(lfoBuffer, count, mathAccuracy);
+            break;
+        case LFOType::Triangle:
+            triangleOSC::shape(lfoBuffer, count, mathAccuracy);
+            break;
+    }
+}
+
+void FilterSynthBank::shapeOscillators(int group, float* oscBuffer, const float* lfoBuffer, int numSamples) const
+{
+    const int first = group * lanes;
+    const int activeLanes = juce::jmin(lanes, numVoices - first);
+    const int count = numSamples * lanes;
+    const OscType type = oscTypes[first];
+
+    // a lane on unison is rendered by its stack afterwards, it has no shape of its own
+    bool shared = true;
+    for (int lane = 0; lane < activeLanes; lane++)
+        shared = shared && oscTypes[first + lane] == type && ! isUnison(first + lane);
+
+    // the PolyBLEP shapes are band-limited by themselves and have no tables
+    if (! shared || (wavetables != nullptr && ! isPolyBlep(type)))
+    {
+        for (int lane = 0; lane < activeLanes; lane++)
+            if (! isUnison(first + lane))
+                shapeOscillatorLane(first + lane, lane, oscBuffer, lfoBuffer, getLane(oscDelta[group], lane), numSamples);
+        return;
+    }
+
+    const auto one = Vec::expand(1.0f);
+    const auto delta = oscDelta[group];
+    const auto inverseDelta = getInverse(delta);
+
+    switch (type)
+    {
+        case OscType::Saw:
+            sawOSC::shape(oscBuffer, count, mathAccuracy);
+            break;
+        case OscType::Square:
+            squareOSC::shape(oscBuffer, count, mathAccuracy);
+            break;
+        case OscType::Triangle:
+            triangleOSC::shape(oscBuffer, count, mathAccuracy);
+            break;
+        case OscType::BlepSaw:
+            for (int i = 0; i < count; i += lanes)
+            {
+                auto p = Vec::fromRawArray(oscBuffer + i);
+                (p * 2.0f - one - polyBlep(p, delta, inverseDelta)).copyToRawArray(oscBuffer + i);
+            }
+            break;
+        case OscType::BlepSquare:
+            for (int i = 0; i < count; i += lanes)
+            {
+                auto p = Vec::fromRawArray(oscBuffer + i);
+                blepPulse(p, delta, inverseDelta, Vec::expand(0.5f)).copyToRawArray(oscBuffer + i);
+            }
+            break;
+        case OscType::BlepPulse:
+        {
+            // the shaped LFO is -1 ~ 1 here, its depth is applied to the cutoff only
+            Vec width, mod;
+            for (int lane = 0; lane < lanes; lane++)
+            {
+                setLane(width, lane, pulseWidth[first + lane]);
+                setLane(mod, lane, pulseWidthMod[first + lane]);
+            }
+
+            const auto minWidth = Vec::expand(0.01f);
+            const auto maxWidth = Vec::expand(0.99f);
+            for (int i = 0; i < count; i += lanes)
+            {
+                auto p = Vec::fromRawArray(oscBuffer + i);
+                auto w = Vec::min(maxWidth, Vec::max(minWidth, width + mod * Vec::fromRawArray(lfoBuffer + i)));
+                blepPulse(p, delta, inverseDelta, w).copyToRawArray(oscBuffer + i);
+            }
+            break;
+        }
+        case OscType::BlampTriangle:
+        {
+            // -1 at phase 0, 1 at phase 0.5, the slope turns by 8 at both corners
+            const auto zero = Vec::expand(0.0f);
+            const auto half = Vec::expand(0.5f);
+            const auto scale = delta * 4.0f;
+            for (int i = 0; i < count; i += lanes)
+            {
+                auto p = Vec::fromRawArray(oscBuffer + i);
+                auto x = p * 2.0f - one;
+                auto output = one - Vec::max(x, zero - x) * 2.0f;
+                output += scale * (polyBlamp(p, delta, inverseDelta) - polyBlamp(wrapPhase(p + half), delta, inverseDelta));
+                output.copyToRawArray(oscBuffer + i);
+            }
+            break;
+        }
+    }
+}
+
+void FilterSynthBank::renderUnison(int group, float* oscBuffer, int numSamples)
+{
+    const int first = group * lanes;
+    const int activeLanes = juce::jmin(lanes, numVoices - first);
+
+    for (int lane = 0; lane < activeLanes; lane++)
+    {
+        int voice = first + lane;
+        if (! isUnison(voice))
+            continue;
+
+        // mono output: the whole stack, otherwise only the voice's side of the field is summed
+        float samples[maxChunkSize];
+        if (numVoices == 1)
+            unison[voice].process(samples, numSamples);
+        else
+            unison[voice].processSide(samples, numSamples, voice % 2 == 1);
+
+        float* x = oscBuffer + lane;
+        for (int i = 0; i < numSamples; i++)
+            x[i * lanes] = samples[i];
+    }
+}
+
+template <typename Shape>
+void FilterSynthBank::shapeStrided(float* x, int numSamples, Shape&& shape)
+{
+    // gathered into a plain array, the block shapes need contiguous samples
+    float samples[maxChunkSize];
+    for (int i = 0; i < numSamples; i++)
+        samples[i] = x[i * lanes];
+
+    shape(samples, numSamples);
+
+    for (int i = 0; i < numSamples; i++)
+        x[i * lanes] = samples[i];
+}
+
+void FilterSynthBank::shapeLFOLane(int voice, int lane, float* lfoBuffer, float phaseDelta, int numSamples) const
+{
+    float* x = lfoBuffer + lane;
+    const int count = numSamples * lanes;
+
+    if (wavetables != nullptr)
+    {
+        // table lookups, the mip level follows each lane's own frequency
+        const auto& lfoTable = getLFOTable(voice);
+        int lfoLevel = lfoTable.getLevelForIncrement(phaseDelta);
+
+        for (int i = 0; i < count; i += lanes)
+            x[i] = lfoTable.read(lfoLevel, x[i]);
+        return;
+    }
+
+    const auto accuracy = mathAccuracy;
+    switch (lfoTypes[voice])
+    {
+        case LFOType::Sine:
+            shapeStrided(x, numSamples, [accuracy] (float* s, int n) { sineOSC::shape(s, n, accuracy); });
+            break;
+        case LFOType::Saw:
+            if (expLFO[voice])
+                shapeStrided(x, numSamples, [accuracy] (float* s, int n) { sawOSC::shapeExponential(s, n, accuracy); });
+            else
+                shapeStrided(x, numSamples, [accuracy] (float* s, int n) { sawOSC::shape(s, n, accuracy); });
+            break;
+        case LFOType::Square:
+            shapeStrided(x, numSamples, [accuracy] (float* s, int n) { squareOSC::shape(s, n, accuracy); });
+            break;
+        case LFOType::Triangle:
+            shapeStrided(x, numSamples, [accuracy] (float* s, int n) { triangleOSC::shape(s, n, accuracy); });
+            break;
+    }
+}
+
+void FilterSynthBank::shapeOscillatorLane(int voice, int lane, float* oscBuffer, const float* lfoBuffer, float phaseDelta, int numSamples) const
+{
+    const OscType type = oscTypes[voice];
+    float* x = oscBuffer + lane;
+    const float* lfo = lfoBuffer + lane;
+    const int count = numSamples * lanes;
+
+    if (wavetables != nullptr && ! isPolyBlep(type))
+    {
+        const auto& oscTable = getOscTable(voice);
+        int oscLevel = oscTable.getLevelForIncrement(phaseDelta);
+
+        for (int i = 0; i < count; i += lanes)
+            x[i] = oscTable.read(oscLevel, x[i]);
+        return;
+    }
+
+    const auto accuracy = mathAccuracy;
+    switch (type)
+    {
+        case OscType::Saw:
+            shapeStrided(x, numSamples, [accuracy] (float* s, int n) { sawOSC::shape(s, n, accuracy); });
+            break;
+        case OscType::Square:
+            shapeStrided(x, numSamples, [accuracy] (float* s, int n) { squareOSC::shape(s, n, accuracy); });
+            break;
+        case OscType::Triangle:
+            shapeStrided(x, numSamples, [accuracy] (float* s, int n) { triangleOSC::shape(s, n, accuracy); });
+            break;
+        case OscType::BlepSaw:
+            for (int i = 0; i < count; i += lanes)
+                x[i] = blepSawOSC::shape(x[i], phaseDelta);
+            break;
+        case OscType::BlepSquare:
+            for (int i = 0; i < count; i += lanes)
+                x[i] = blepPulseOSC::shape(x[i], phaseDelta, 0.5f);
+            break;
+        case OscType::BlepPulse:
+        {
+            const float width = pulseWidth[voice];
+            const float mod = pulseWidthMod[voice];
+            for (int i = 0; i < count; i += lanes)
+                x[i] = blepPulseOSC::shape(x[i], phaseDelta, juce::jlimit(0.01f, 0.99f, width + mod * lfo[i]));
+            break;
+        }
+        case OscType::BlampTriangle:
+            for (int i = 0; i < count; i += lanes)
+                x[i] = blampTriangleOSC::shape(x[i], phaseDelta);
+            break;
+    }
+}
@@ -0,0 +1,134 @@
+/*
+  ==============================================================================
+
+    FilterSynthBank.h
+    A bank of FilterSynth-equivalent voices stored structure-of-arrays, so the
+    oscillator phases, LFOs and biquads of several voices run in SIMD lanes.
+    Created: 17 Oct 2026 10:12:41am
+    Author:  chenzuyu
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <JuceHeader.h>
+#include "FilterSynth.h"
+
+class FilterSynthBank
+{
+public:
+    using Vec = juce::dsp::SIMDRegister<float>;
+
+    static constexpr int lanes = (int) Vec::SIMDNumElements; // voices per SIMD register
+    static constexpr int maxVoices = 16;
+    static constexpr int maxGroups = maxVoices / lanes;
+
+    FilterSynthBank();
+
+    void setSampleRate(float sr);
+    void setNumVoices(int n); // number of active voices, up to maxVoices
+    int getNumVoices() const { return numVoices; }
+    int getNumGroups() const { return numGroups; } // SIMD registers needed for the active voices
+
+    // Per voice setters, same arguments as the FilterSynth ones
+    void setOSC(int voice, OscType oscType, float frequency, float phase);
+    void setLFO(int voice, LFOType lfoType, float rate, float depth, float phase);
+    void setExponentialLFO(int voice, bool exponential); // exponential ramping for a Saw LFO
+    void setFilter(int voice, FilterType filterType, float fc, float resonance);
+    void setPulseWidth(int voice, float width, float modDepth); // BlepPulse width, the LFO swings it by +-modDepth
+
+    // Unison: a stack of detuned PolyBLEP saws in place of the voice's oscillator, 1 voice turns it off.
+    // Voice v plays the left side of its stack if v is even and the right side if odd, as the
+    // MIDI voices spread over the channels. Not cheap to change, call when the settings move
+    void setUnison(int voice, int numUnisonVoices, float detuneCents, float stereoWidth);
+
+    // Parameter updates that keep the running phases and filter state
+    void setOSCType(int voice, OscType oscType);
+    void setOSCFrequency(int voice, float frequency);
+    void setLFOType(int voice, LFOType lfoType);
+    void setLFORate(int voice, float rate);
+    void setLFODepth(int voice, float depth);
+    void setFilterType(int voice, FilterType filterType); // a biquad response ramps in at the next coefficient update
+    void setCutoff(int voice, float fc);
+    void setResonance(int voice, float resonance);
+    void setWavetables(const WavetableSet* tables); // shape from baked tables, nullptr to compute the waveshapes
+    void setMathAccuracy(MathAccuracy accuracy); // how the computed waveshapes evaluate tanh, sin and exp2
+    void setControlRate(int samplesPerUpdate); // shared by all voices
+    float getCoeffUpdatesPerSecond() const; // biquad updates summed over all voices, measured over the last block
+
+    // Audio-rate cutoff offset in Hz added to every voice, nullptr for none. Read from
+    // sample i >> log2SamplesPerValue, e.g. a base-rate buffer under oversampling.
+    // Must stay valid until the next process call
+    void setCutoffModulation(const float* modulation, int log2SamplesPerValue);
+
+    // Render numSamples for every active voice, dest[v] receives voice v
+    void process(float* const* dest, int numSamples);
+
+    // Render the voices of one group only. Groups share no state, so
+    // different groups may render on different threads at the same time
+    void processGroup(int group, float* const* dest, int numSamples);
+
+private:
+    void processChunk(int group, float* const* dest, int startSample, int numSamples);
+
+    // Phases to waveforms in place, the buffers hold lane l of sample i at i * lanes + l.
+    // A group whose lanes share a waveform is shaped in one pass over the whole chunk,
+    // a mixed group and the table reads go lane by lane. The computed shapes run through
+    // the block versions of the oscillators' shapes, in the selected MathAccuracy tier
+    void shapeLFOs(int group, float* lfoBuffer, int numSamples) const;
+    void shapeOscillators(int group, float* oscBuffer, const float* lfoBuffer, int numSamples) const;
+    void shapeLFOLane(int voice, int lane, float* lfoBuffer, float phaseDelta, int numSamples) const;
+    void shapeOscillatorLane(int voice, int lane, float* oscBuffer, const float* lfoBuffer, float phaseDelta, int numSamples) const;
+    void renderUnison(int group, float* oscBuffer, int numSamples); // the lanes on unison, skipped by the shaping
+    bool isUnison(int voice) const { return unison[voice].getNumVoices() > 1; }
+    void updateCoefficients(int group, const Vec& modCutoff); // counts into coeffUpdateCount[group]
+    juce::IIRCoefficients makeCoefficients(int voice, float modCutoff) const;
+    const Wavetable& getOscTable(int voice) const;
+    const Wavetable& getLFOTable(int voice) const;
+    template <typename Shape>
+    static void shapeStrided(float* x, int numSamples, Shape&& shape); // one lane through a block shape
+
+    static float getLane(const Vec& v, int lane) { return v.get((size_t) lane); }
+    static void setLane(Vec& v, int lane, float x) { v.set((size_t) lane, x); }
+
+    float sampleRate = 48000.0f;
+    int numVoices = 0;
+    int numGroups = 0;
+    const WavetableSet* wavetables = nullptr;
+    MathAccuracy mathAccuracy = MathAccuracy::Exact;
+
+    // Per voice settings
+    OscType oscTypes[maxVoices];
+    LFOType lfoTypes[maxVoices];
+    bool expLFO[maxVoices];
+    FilterType filterTypes[maxVoices];
+    float oscFrequency[maxVoices];
+    float lfoRate[maxVoices];
+    float resonance[maxVoices];
+    float pulseWidth[maxVoices];
+    float pulseWidthMod[maxVoices];
+    UnisonOscillator unison[maxVoices];
+
+    // Per voice state, one SIMD register per group of voices
+    Vec oscPhase[maxGroups], oscDelta[maxGroups];
+    Vec lfoPhase[maxGroups], lfoDelta[maxGroups], lfoDepth[maxGroups];
+    Vec cutoff[maxGroups];
+    const float* cutoffModulation = nullptr;
+    int cutoffModulationShift = 0;
+    Vec coeffs[maxGroups][5], coeffSteps[maxGroups][5];
+    Vec v1[maxGroups], v2[maxGroups];
+    Vec svf1[maxGroups], svf2[maxGroups]; // state-variable filter integrators, for the lanes on an SVF type
+    const TanLookup& tanLookup = TanLookup::get();
+
+    // Control-rate coefficient updates
+    int controlRate = 1;
+    int samplesUntilUpdate[maxGroups] = {};
+    int coeffUpdateCount[maxGroups] = {};
+    float coeffUpdatesPerSecond[maxGroups] = {};
+
+    // Scratch space per group, one register per sample, blocks larger than this are split into chunks.
+    // Plain floats so the shaping can run over them as one array, loaded with Vec::fromRawArray
+    static constexpr int maxChunkSize = 64;
+    alignas (Vec::SIMDRegisterSize) float oscBuffer[maxGroups][maxChunkSize * lanes];
+    alignas (Vec::SIMDRegisterSize) float lfoBuffer[maxGroups][maxChunkSize * lanes];
+};
@@ -0,0 +1,69 @@
+/*
+  ==============================================================================
+
+    MemoryArena.h
+    One preallocated block of floats handed out in slices, so that memory the
+    audio thread needs can be laid out again without allocating.
+    Created: 17 Oct 2026 10:02:51pm
+    Author:  chenzuyu
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <JuceHeader.h>
+
+class MemoryArena
+{
+public:
+    static constexpr size_t alignment = 64 / sizeof(float); // slices start on a cache line, in floats
+
+    // Floats a slice of numFloats takes up, slices are padded to the alignment.
+    // reserve() the sum of these for the slices that will be allocated
+    static size_t getSliceSize(size_t numFloats)
+    {
+        return (numFloats + alignment - 1) / alignment * alignment;
+    }
+
+    // Allocate the block, not real-time safe. Keeps the current block when it is
+    // big enough, otherwise every slice handed out so far becomes invalid
+    void reserve(size_t numFloats)
+    {
+        numFloats = getSliceSize(numFloats);
+        if (numFloats <= capacity)
+            return;
+
+        storage.allocate(numFloats + alignment, false);
+        auto misalignment = (size_t) (reinterpret_cast<juce::pointer_sized_uint> (storage.get()) / sizeof(float)) % alignment;
+        base = storage.get() + (alignment - misalignment) % alignment;
+        capacity = numFloats;
+        used = 0;
+    }
+
+    // Hand out the next slice, real-time safe. nullptr when the block is too small
+    float* allocate(size_t numFloats)
+    {
+        numFloats = getSliceSize(numFloats);
+        if (used + numFloats > capacity)
+        {
+            jassertfalse; // reserve() was called for less
+            return nullptr;
+        }
+
+        float* slice = base + used;
+        used += numFloats;
+        return slice;
+    }
+
+    // Take every slice back, the next allocate() calls reuse the memory. Real-time safe
+    void reset() { used = 0; }
+
+    size_t getCapacity() const { return capacity; }
+    size_t getNumUsed() const { return used; }
+
+private:
+    juce::HeapBlock<float> storage;
+    float* base = nullptr;
+    size_t capacity = 0;
+    size_t used = 0;
+};
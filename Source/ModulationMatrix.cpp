@@ -0,0 +1,106 @@
+/*
+  ==============================================================================
+
+    ModulationMatrix.cpp
+    Block-rate modulation routing: every source is rendered once per block
+    into its own buffer, every destination buffer is its offset plus one
+    multiply-add pass per route into it. Per-voice sources stay inside the
+    voices, which apply the amounts of their routes themselves.
+    Created: 17 Oct 2026 10:41:17pm
+    Author:  chenzuyu
+
+  ==============================================================================
+*/
+
+#include "ModulationMatrix.h"
+
+void ModulationMatrix::prepare(int numSources, int numDestinations, int maxBlockSize)
+{
+    jassert(numSources <= maxSources && numDestinations <= maxDestinations);
+
+    // only ever grown, a smaller block size keeps the memory
+    sources.setSize(juce::jmin(numSources, maxSources), maxBlockSize, false, true, true);
+    destinations.setSize(juce::jmin(numDestinations, maxDestinations), maxBlockSize, false, true, true);
+}
+
+void ModulationMatrix::setOffset(int destination, float offset)
+{
+    offsets[destination] = offset;
+}
+
+int ModulationMatrix::addRoute(int source, int destination, float amount)
+{
+    jassert(source >= 0 && source < maxSources && destination >= 0 && destination < maxDestinations);
+
+    if (numRoutes == maxRoutes)
+        return -1;
+
+    routes[numRoutes] = { source, destination, amount };
+    return numRoutes++;
+}
+
+void ModulationMatrix::setRouteAmount(int route, float amount)
+{
+    jassert(route >= 0 && route < numRoutes);
+    routes[route].amount = amount;
+}
+
+void ModulationMatrix::clearRoutes()
+{
+    numRoutes = 0;
+}
+
+bool ModulationMatrix::isSourceUsed(int source) const
+{
+    for (int r = 0; r < numRoutes; r++)
+        if (routes[r].source == source && routes[r].amount != 0.0f)
+            return true;
+
+    return false;
+}
+
+bool ModulationMatrix::hasModulation(int destination) const
+{
+    for (int r = 0; r < numRoutes; r++)
+        if (routes[r].destination == destination && routes[r].amount != 0.0f && ! voiceSources[routes[r].source])
+            return true;
+
+    return false;
+}
+
+void ModulationMatrix::setVoiceSource(int source, bool isPerVoice)
+{
+    jassert(source >= 0 && source < maxSources);
+    voiceSources[source] = isPerVoice;
+}
+
+float ModulationMatrix::getVoiceAmount(int source, int destination) const
+{
+    jassert(voiceSources[source]);
+
+    float amount = 0.0f;
+    for (int r = 0; r < numRoutes; r++)
+        if (routes[r].source == source && routes[r].destination == destination)
+            amount += routes[r].amount;
+
+    return amount;
+}
+
+void ModulationMatrix::process(int numSamples)
+{
+    jassert(numSamples <= destinations.getNumSamples());
+
+    for (int d = 0; d < destinations.getNumChannels(); d++)
+        juce::FloatVectorOperations::fill(destinations.getWritePointer(d), offsets[d], numSamples);
+
+    // one pass per route, the cost grows with the routes and not with a per-sample call graph
+    for (int r = 0; r < numRoutes; r++)
+    {
+        const auto& route = routes[r];
+        if (route.amount == 0.0f || voiceSources[route.source])
+            continue;
+
+        juce::FloatVectorOperations::addWithMultiply(destinations.getWritePointer(route.destination),
+                                                     sources.getReadPointer(route.source), route.amount, numSamples);
+    }
+}
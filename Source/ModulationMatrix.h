@@ -0,0 +1,68 @@
+/*
+  ==============================================================================
+
+    ModulationMatrix.h
+    Block-rate modulation routing: every source is rendered once per block
+    into its own buffer, every destination buffer is its offset plus one
+    multiply-add pass per route into it. Per-voice sources stay inside the
+    voices, which apply the amounts of their routes themselves.
+    Created: 17 Oct 2026 10:41:17pm
+    Author:  chenzuyu
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <JuceHeader.h>
+
+class ModulationMatrix
+{
+public:
+    static constexpr int maxSources = 8;
+    static constexpr int maxDestinations = 8;
+    static constexpr int maxRoutes = 32;
+
+    // Allocate the source and destination buffers, not real-time safe
+    void prepare(int numSources, int numDestinations, int maxBlockSize);
+
+    // The value of a destination without any modulation
+    void setOffset(int destination, float offset);
+
+    // Routes: destination += amount * source, per sample. Real-time safe
+    int addRoute(int source, int destination, float amount); // the route index, -1 when full
+    void setRouteAmount(int route, float amount);
+    void clearRoutes();
+    int getNumRoutes() const { return numRoutes; }
+
+    bool isSourceUsed(int source) const;     // a route with a non-zero amount reads it, else it need not be rendered
+    bool hasModulation(int destination) const; // a route from a buffer source with a non-zero amount writes it
+
+    // A per-voice source, e.g. each voice's own LFO, has no buffer: process() skips its routes
+    // and every voice adds getVoiceAmount * its own value of the source to the destination
+    void setVoiceSource(int source, bool isPerVoice);
+    float getVoiceAmount(int source, int destination) const; // the amounts of its routes into destination, summed
+
+    // Render the used sources into these, then call process()
+    float* getSourceBuffer(int source) { return sources.getWritePointer(source); }
+
+    // Fill every destination buffer for the next numSamples, at most maxBlockSize
+    void process(int numSamples);
+
+    const float* getDestinationBuffer(int destination) const { return destinations.getReadPointer(destination); }
+
+private:
+    struct Route
+    {
+        int source = 0;
+        int destination = 0;
+        float amount = 0.0f;
+    };
+
+    Route routes[maxRoutes];
+    int numRoutes = 0;
+    float offsets[maxDestinations] = {};
+    bool voiceSources[maxSources] = {};
+
+    juce::AudioBuffer<float> sources;
+    juce::AudioBuffer<float> destinations;
+};
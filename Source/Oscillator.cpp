@@ -12,6 +12,7 @@
 #include <iostream>
 #include <vector>
 #include <ctime>
+#include <algorithm>
 #include "Oscillator.h"
 
 /**
@@ -21,7 +22,7 @@
  */
 
 Oscillator::Oscillator()
-: sampleRate(48000), gain(1) {}  // Constructor, set to the default gain
+: frequency(0), sampleRate(48000), gain(1) {}  // Constructor, set to the default gain
     
 Oscillator::~Oscillator(){
     
@@ -29,10 +30,14 @@ Oscillator::~Oscillator(){
     
 void Oscillator::setSampleRate(float sr){
     sampleRate = sr;
+    updateWavetableLevel();
+    updatePhaseIncrement();
 }
     
 void Oscillator::setFrequency(float f){
     frequency = f;
+    updateWavetableLevel();
+    updatePhaseIncrement();
 }
 
 void Oscillator::setGain(float g){
@@ -41,10 +46,256 @@ void Oscillator::setGain(float g){
 
 void Oscillator::setPhase(float p){
     phase = p;
+    // int64 to uint32 wraps modulo 2^32, so a phase of 1 or below 0 still lands in the cycle
+    phaseAccumulator = (std::uint32_t) std::llround((double) p * fixedPointScale);
 }
+
+void Oscillator::setFixedPointPhase(bool enabled){
+    // carry the running phase over in both directions
+    if (enabled && ! fixedPointPhase)
+        setPhase(phase);
+    
+    fixedPointPhase = enabled;
+}
+
+void Oscillator::updatePhaseIncrement(){
+    // rounded once here, the accumulator then advances exactly this much every sample
+    double delta = (double) frequency / (double) sampleRate;
+    phaseIncrement = (std::uint32_t) std::llround((delta - std::floor(delta)) * fixedPointScale);
+}
+
+// Oscillators without a baked waveshape keep computing it
+void Oscillator::setWavetables(const WavetableSet* tables){
+    setWavetable(nullptr);
+}
+
+void Oscillator::setWavetable(const Wavetable* table){
+    wavetable = (table != nullptr && ! table->isEmpty()) ? table : nullptr;
+    updateWavetableLevel();
+}
+
+void Oscillator::updateWavetableLevel(){
+    // the mip level only changes with the frequency or sample rate, not per sample
+    if (wavetable != nullptr)
+        wavetableLevel = wavetable->getLevelForIncrement(frequency/sampleRate);
+}
+
+float Oscillator::readWavetable(const Wavetable& table){
+    
+    if (fixedPointPhase)
+    {
+        float output = table.readFixed(wavetableLevel, phaseAccumulator);
+        phaseAccumulator += phaseIncrement;
+        phase = toPhase(phaseAccumulator);
+        return gain*output;
+    }
+    
+    float output = table.read(wavetableLevel, phase);
+    phaseDelta = frequency/sampleRate;
+    phase += phaseDelta;
+    
+    if (phase > 1)
+    {
+        phase -= 1;
+    }
+    
+    return gain*output;
+}
+
+void Oscillator::renderWavetable(const Wavetable& table, float* dest, int numSamples){
+    
+    if (fixedPointPhase)
+    {
+        std::uint32_t acc = phaseAccumulator;
+        
+        for (int i = 0; i < numSamples; i++)
+        {
+            dest[i] = gain*table.readFixed(wavetableLevel, acc);
+            acc += phaseIncrement; // wraps by overflow
+        }
+        
+        phaseAccumulator = acc;
+        phase = toPhase(acc);
+        return;
+    }
+    
+    phaseDelta = frequency/sampleRate;
+    float p = phase;
+    
+    for (int i = 0; i < numSamples; i++)
+    {
+        float output = table.read(wavetableLevel, p);
+        p += phaseDelta;
+        
+        if (p > 1)
+        {
+            p -= 1;
+        }
+        
+        dest[i] = gain*output;
+    }
+    
+    phase = p;
+}
+
+// Computed waveshapes use libm in double precision in the Exact tier, FastMath otherwise
+void Oscillator::setMathAccuracy(MathAccuracy accuracy){
+    mathAccuracy = accuracy;
+}
+
+void Oscillator::renderPhases(float* dest, int numSamples){
+    
+    if (fixedPointPhase)
+    {
+        phaseDelta = toPhase(phaseIncrement);
+        std::uint32_t acc = phaseAccumulator;
+        
+        for (int i = 0; i < numSamples; i++)
+        {
+            dest[i] = toPhase(acc);
+            acc += phaseIncrement;
+        }
+        
+        phaseAccumulator = acc;
+        phase = toPhase(acc);
+        return;
+    }
+    
+    phaseDelta = frequency/sampleRate;
+    float p = phase;
+    
+    for (int i = 0; i < numSamples; i++)
+    {
+        dest[i] = p;
+        p += phaseDelta;
+        
+        if (p > 1)
+        {
+            p -= 1;
+        }
+    }
+    
+    phase = p;
+}
+
+void Oscillator::advancePhase(int numSamples){
+    
+    if (fixedPointPhase)
+    {
+        phaseAccumulator += phaseIncrement * (std::uint32_t) numSamples;
+        phase = toPhase(phaseAccumulator);
+        return;
+    }
+    
+    phaseDelta = frequency/sampleRate;
+    float p = phase;
+    
+    for (int i = 0; i < numSamples; i++)
+    {
+        p += phaseDelta;
+        
+        if (p > 1)
+        {
+            p -= 1;
+        }
+    }
+    
+    phase = p;
+}
+
+// Scalar waveshapes in the High and Fast tiers, the block versions call FastMath directly
+static float approxSin2Pi(float phase, MathAccuracy accuracy){
+    return accuracy == MathAccuracy::High ? FastMath::sin2Pi<MathAccuracy::High>(phase)
+                                          : FastMath::sin2Pi<MathAccuracy::Fast>(phase);
+}
+
+static float approxTanh(float x, MathAccuracy accuracy){
+    return accuracy == MathAccuracy::High ? FastMath::tanh<MathAccuracy::High>(x)
+                                          : FastMath::tanh<MathAccuracy::Fast>(x);
+}
+
+static float approxExp2(float x, MathAccuracy accuracy){
+    return accuracy == MathAccuracy::High ? FastMath::exp2<MathAccuracy::High>(x)
+                                          : FastMath::exp2<MathAccuracy::Fast>(x);
+}
+
+static constexpr float sawScaling = 2.29755993f; // atanh(0.98)
+static constexpr float log2Of2_7 = 1.43295941f; // pow(2.7, x) = exp2(x*log2(2.7))
+
+// The saw waveshape over a block of phases in the High and Fast tiers, in place
+template <MathAccuracy accuracy>
+static void shapeSawApproximate(float* dest, int numSamples, bool exponential){
+    
+    if (exponential)
+    {
+        for (int i = 0; i < numSamples; i++)
+        {
+            dest[i] *= log2Of2_7;
+        }
+        
+        FastMath::exp2<accuracy>(dest, dest, numSamples);
+        
+        // tanh(scaling*2*(exp_phase - 0.5)) with exp_phase = 2.7^phase - 1
+        for (int i = 0; i < numSamples; i++)
+        {
+            dest[i] = sawScaling*(2*dest[i] - 3);
+        }
+    }
+    else
+    {
+        for (int i = 0; i < numSamples; i++)
+        {
+            dest[i] = sawScaling*(2*dest[i] - 1);
+        }
+    }
+    
+    FastMath::tanh<accuracy>(dest, dest, numSamples);
+}
+
+// Fallback block renderer for subclasses without a dedicated loop
+void Oscillator::process(float* dest, int numSamples){
+    for (int i = 0; i < numSamples; i++)
+    {
+        dest[i] = process();
+    }
+}
+
+float sineOSC::shape(float phase){
+    return sin(2*M_PI*phase);
+}
+
+void sineOSC::shape(float* phases, int numSamples, MathAccuracy accuracy){
+    switch (accuracy)
+    {
+        case MathAccuracy::High:  FastMath::sin2Pi<MathAccuracy::High>(phases, phases, numSamples); return;
+        case MathAccuracy::Fast:  FastMath::sin2Pi<MathAccuracy::Fast>(phases, phases, numSamples); return;
+        case MathAccuracy::Exact: break;
+    }
+    
+    for (int i = 0; i < numSamples; i++)
+    {
+        phases[i] = shape(phases[i]);
+    }
+}
+
+void sineOSC::setWavetables(const WavetableSet* tables){
+    setWavetable(tables != nullptr ? &tables->sine : nullptr);
+}
+
 float sineOSC::process(){
     
-    float output = sin(2*M_PI*phase);
+    // a block of one, the block renderer handles the fixed-point phase
+    if (fixedPointPhase)
+    {
+        float output;
+        sineOSC::process(&output, 1);
+        return output;
+    }
+    
+    if (wavetable != nullptr)
+        return readWavetable(*wavetable);
+    
+    float output = (mathAccuracy == MathAccuracy::Exact) ? sin(2*M_PI*phase) : approxSin2Pi(phase, mathAccuracy);
     phaseDelta = frequency/sampleRate;
     phase += phaseDelta;
     
@@ -56,10 +307,124 @@ float sineOSC::process(){
     return gain*output;
 }
 
+void sineOSC::process(float* dest, int numSamples){
+    
+    if (wavetable != nullptr)
+    {
+        renderWavetable(*wavetable, dest, numSamples);
+        return;
+    }
+    
+    switch (mathAccuracy)
+    {
+        case MathAccuracy::High:  processApproximate<MathAccuracy::High>(dest, numSamples); return;
+        case MathAccuracy::Fast:  processApproximate<MathAccuracy::Fast>(dest, numSamples); return;
+        case MathAccuracy::Exact: break;
+    }
+    
+    if (fixedPointPhase)
+    {
+        renderPhases(dest, numSamples);
+        
+        for (int i = 0; i < numSamples; i++)
+        {
+            dest[i] = gain*shape(dest[i]);
+        }
+        return;
+    }
+    
+    // the increment is constant over the block, so compute it once
+    phaseDelta = frequency/sampleRate;
+    float p = phase;
+    
+    for (int i = 0; i < numSamples; i++)
+    {
+        float output = sin(2*M_PI*p);
+        p += phaseDelta;
+        
+        if (p > 1)
+        {
+            p -= 1;
+        }
+        
+        dest[i] = gain*output;
+    }
+    
+    phase = p;
+}
+
+template <MathAccuracy accuracy>
+void sineOSC::processApproximate(float* dest, int numSamples){
+    
+    renderPhases(dest, numSamples);
+    FastMath::sin2Pi<accuracy>(dest, dest, numSamples);
+    
+    for (int i = 0; i < numSamples; i++)
+    {
+        dest[i] *= gain;
+    }
+}
+
+float sawOSC::shape(float phase){
+    float scaling_factor = atanh(0.98);
+    return tanh(scaling_factor*2*(phase - 0.5));
+}
+
+float sawOSC::shapeExponential(float phase){
+    float scaling_factor = atanh(0.98);
+    float exp_phase = pow(2.7, phase) - 1;  // Exponential shaping
+    return tanh(scaling_factor*2*(exp_phase - 0.5));
+}
+
+void sawOSC::shape(float* phases, int numSamples, MathAccuracy accuracy){
+    switch (accuracy)
+    {
+        case MathAccuracy::High:  shapeSawApproximate<MathAccuracy::High>(phases, numSamples, false); return;
+        case MathAccuracy::Fast:  shapeSawApproximate<MathAccuracy::Fast>(phases, numSamples, false); return;
+        case MathAccuracy::Exact: break;
+    }
+    
+    for (int i = 0; i < numSamples; i++)
+    {
+        phases[i] = shape(phases[i]);
+    }
+}
+
+void sawOSC::shapeExponential(float* phases, int numSamples, MathAccuracy accuracy){
+    switch (accuracy)
+    {
+        case MathAccuracy::High:  shapeSawApproximate<MathAccuracy::High>(phases, numSamples, true); return;
+        case MathAccuracy::Fast:  shapeSawApproximate<MathAccuracy::Fast>(phases, numSamples, true); return;
+        case MathAccuracy::Exact: break;
+    }
+    
+    for (int i = 0; i < numSamples; i++)
+    {
+        phases[i] = shapeExponential(phases[i]);
+    }
+}
+
+void sawOSC::setWavetables(const WavetableSet* tables){
+    setWavetable(tables != nullptr ? &tables->saw : nullptr);
+    expWavetable = (wavetable != nullptr) ? &tables->sawExponential : nullptr;
+}
+
 // default sawOSC
 float sawOSC::process(){
+    
+    if (fixedPointPhase)
+    {
+        float output;
+        sawOSC::process(&output, 1);
+        return output;
+    }
+    
+    if (wavetable != nullptr)
+        return readWavetable(*wavetable);
+    
     float scaling_factor = atanh(0.98);
-    float output = tanh(scaling_factor*2*(phase - 0.5));
+    float output = (mathAccuracy == MathAccuracy::Exact) ? tanh(scaling_factor*2*(phase - 0.5))
+                                                         : approxTanh(sawScaling*(2*phase - 1), mathAccuracy);
     
     // phase increment
     phaseDelta = frequency/sampleRate;
@@ -74,21 +439,83 @@ float sawOSC::process(){
     return gain*output;
 }
 
+void sawOSC::process(float* dest, int numSamples){
+    
+    if (wavetable != nullptr)
+    {
+        renderWavetable(*wavetable, dest, numSamples);
+        return;
+    }
+    
+    switch (mathAccuracy)
+    {
+        case MathAccuracy::High:  processApproximate<MathAccuracy::High>(dest, numSamples, false); return;
+        case MathAccuracy::Fast:  processApproximate<MathAccuracy::Fast>(dest, numSamples, false); return;
+        case MathAccuracy::Exact: break;
+    }
+    
+    if (fixedPointPhase)
+    {
+        renderPhases(dest, numSamples);
+        
+        for (int i = 0; i < numSamples; i++)
+        {
+            dest[i] = gain*shape(dest[i]);
+        }
+        return;
+    }
+    
+    float scaling_factor = atanh(0.98);
+    phaseDelta = frequency/sampleRate;
+    float p = phase;
+    
+    for (int i = 0; i < numSamples; i++)
+    {
+        float output = tanh(scaling_factor*2*(p - 0.5));
+        p += phaseDelta;
+        
+        if (p > 1)
+        {
+            p -= 1;
+        }
+        
+        dest[i] = gain*output;
+    }
+    
+    phase = p;
+}
+
 // exponential sawOSC
 float sawOSC::process(bool exponential){
     
+    if (fixedPointPhase)
+    {
+        float output;
+        sawOSC::process(&output, 1, exponential);
+        return output;
+    }
+    
+    if (exponential && expWavetable != nullptr)
+        return readWavetable(*expWavetable);
+    
+    // the default saw advances the phase itself
+    if (! exponential)
+        return sawOSC::process();
+    
     float scaling_factor = atanh(0.98);
-    float output;
+    
+    // Transform phase into an exponential curve
     float exp_phase;
-    if (exponential)
+    float output;
+    if (mathAccuracy == MathAccuracy::Exact)
     {
-        // Transform phase into an exponential curve
         exp_phase = pow(2.7, phase) - 1;  // Exponential shaping
         output = tanh(scaling_factor*2*(exp_phase - 0.5));
     }
     else
     {
-        output = sawOSC::process();
+        exp_phase = approxExp2(log2Of2_7*phase, mathAccuracy) - 1;
+        output = approxTanh(sawScaling*(2*exp_phase - 1), mathAccuracy);
     }
     
 //    float output = 2*(phase-0.5);
@@ -106,15 +533,141 @@ float sawOSC::process(bool exponential){
     return gain*output;
 }
 
+// block version of the exponential sawOSC, the phase advances once per sample
+void sawOSC::process(float* dest, int numSamples, bool exponential){
+    
+    if (! exponential)
+    {
+        process(dest, numSamples);
+        return;
+    }
+    
+    if (expWavetable != nullptr)
+    {
+        renderWavetable(*expWavetable, dest, numSamples);
+        return;
+    }
+    
+    switch (mathAccuracy)
+    {
+        case MathAccuracy::High:  processApproximate<MathAccuracy::High>(dest, numSamples, true); return;
+        case MathAccuracy::Fast:  processApproximate<MathAccuracy::Fast>(dest, numSamples, true); return;
+        case MathAccuracy::Exact: break;
+    }
+    
+    if (fixedPointPhase)
+    {
+        renderPhases(dest, numSamples);
+        
+        for (int i = 0; i < numSamples; i++)
+        {
+            dest[i] = gain*shapeExponential(dest[i]);
+        }
+        return;
+    }
+    
+    float scaling_factor = atanh(0.98);
+    phaseDelta = frequency/sampleRate;
+    float p = phase;
+    
+    for (int i = 0; i < numSamples; i++)
+    {
+        float exp_phase = pow(2.7, p) - 1;  // Exponential shaping
+        float output = tanh(scaling_factor*2*(exp_phase - 0.5));
+        p += phaseDelta;
+        
+        if (p > 1)
+        {
+            p -= 1;
+        }
+        
+        dest[i] = gain*output;
+    }
+    
+    phase = p;
+}
+
+template <MathAccuracy accuracy>
+void sawOSC::processApproximate(float* dest, int numSamples, bool exponential){
+    
+    renderPhases(dest, numSamples);
+    shapeSawApproximate<accuracy>(dest, numSamples, exponential);
+    
+    for (int i = 0; i < numSamples; i++)
+    {
+        dest[i] *= gain;
+    }
+}
+
+float squareOSC::shape(float phase){
+    float scaling_factor = 10;
+    return tanh(scaling_factor*sineOSC::shape(phase));
+}
+
+void squareOSC::shape(float* phases, int numSamples, MathAccuracy accuracy){
+    if (accuracy == MathAccuracy::Exact)
+    {
+        for (int i = 0; i < numSamples; i++)
+        {
+            phases[i] = shape(phases[i]);
+        }
+        return;
+    }
+    
+    float scaling_factor = 10;
+    sineOSC::shape(phases, numSamples, accuracy);
+    
+    for (int i = 0; i < numSamples; i++)
+    {
+        phases[i] *= scaling_factor;
+    }
+    
+    if (accuracy == MathAccuracy::High)
+        FastMath::tanh<MathAccuracy::High>(phases, phases, numSamples);
+    else
+        FastMath::tanh<MathAccuracy::Fast>(phases, phases, numSamples);
+}
+
+void squareOSC::setWavetables(const WavetableSet* tables){
+    setWavetable(tables != nullptr ? &tables->square : nullptr);
+}
+
+void squareOSC::setMathAccuracy(MathAccuracy accuracy){
+    mathAccuracy = accuracy;
+    sine.setMathAccuracy(accuracy);
+}
+
+void squareOSC::setPhase(float p){
+    Oscillator::setPhase(p);
+    sine.setPhase(p);
+}
+
+void squareOSC::setFixedPointPhase(bool enabled){
+    Oscillator::setFixedPointPhase(enabled);
+    sine.setFixedPointPhase(enabled);
+}
+
 float squareOSC::process(){
     
+    if (fixedPointPhase)
+    {
+        float output;
+        squareOSC::process(&output, 1);
+        return output;
+    }
+    
+    // the table is read with the square's own phase rather than the embedded sine's
+    if (wavetable != nullptr)
+        return readWavetable(*wavetable);
+    
     float output;
     // harnessing soft clipping funciton tanh() to emulate square wave without causing aliasing
     float scaling_factor = 10;
     
     sine.setFrequency(frequency);
     sine.setSampleRate(sampleRate);
-    output = tanh(scaling_factor*sine.process());
+    output = (mathAccuracy == MathAccuracy::Exact) ? tanh(scaling_factor*sine.process())
+                                                   : approxTanh(scaling_factor*sine.process(), mathAccuracy);
 //    if (phase < 0.5)
 //    {
 //        output = -1;
@@ -136,8 +689,140 @@ float squareOSC::process(){
     return gain*output;
 }
 
+void squareOSC::process(float* dest, int numSamples){
+    
+    if (wavetable != nullptr)
+    {
+        renderWavetable(*wavetable, dest, numSamples);
+        return;
+    }
+    
+    switch (mathAccuracy)
+    {
+        case MathAccuracy::High:  processApproximate<MathAccuracy::High>(dest, numSamples); return;
+        case MathAccuracy::Fast:  processApproximate<MathAccuracy::Fast>(dest, numSamples); return;
+        case MathAccuracy::Exact: break;
+    }
+    
+    float scaling_factor = 10;
+    
+    // render the whole sine block first, then shape it in place
+    sine.setFrequency(frequency);
+    sine.setSampleRate(sampleRate);
+    sine.process(dest, numSamples);
+    
+    if (fixedPointPhase)
+    {
+        for (int i = 0; i < numSamples; i++)
+        {
+            dest[i] = gain*tanh(scaling_factor*dest[i]);
+        }
+        
+        advancePhase(numSamples);
+        return;
+    }
+    
+    phaseDelta = frequency/sampleRate;
+    float p = phase;
+    
+    for (int i = 0; i < numSamples; i++)
+    {
+        float output = tanh(scaling_factor*dest[i]);
+        p += phaseDelta;
+        
+        if (p > 1)
+        {
+            p -= 1;
+        }
+        
+        dest[i] = gain*output;
+    }
+    
+    phase = p;
+}
+
+template <MathAccuracy accuracy>
+void squareOSC::processApproximate(float* dest, int numSamples){
+    
+    float scaling_factor = 10;
+    
+    // the embedded sine is on the same tier, see setMathAccuracy
+    sine.setFrequency(frequency);
+    sine.setSampleRate(sampleRate);
+    sine.process(dest, numSamples);
+    
+    for (int i = 0; i < numSamples; i++)
+    {
+        dest[i] *= scaling_factor;
+    }
+    
+    FastMath::tanh<accuracy>(dest, dest, numSamples);
+    
+    for (int i = 0; i < numSamples; i++)
+    {
+        dest[i] *= gain;
+    }
+    
+    // the square keeps its own phase for the wavetable reads
+    advancePhase(numSamples);
+}
+
+float triangleOSC::shape(float phase){
+    // the embedded saw runs in phase with the triangle
+    float output = (phase < 0.5) ? -sawOSC::shape(phase) : sawOSC::shape(phase);
+    return 2 * (output - 0.5);
+}
+
+void triangleOSC::shape(float* phases, int numSamples, MathAccuracy accuracy){
+    if (accuracy == MathAccuracy::Exact)
+    {
+        for (int i = 0; i < numSamples; i++)
+        {
+            phases[i] = shape(phases[i]);
+        }
+        return;
+    }
+    
+    // the saw is negative below phase 0.5, so flipping it there is its magnitude
+    sawOSC::shape(phases, numSamples, accuracy);
+    
+    for (int i = 0; i < numSamples; i++)
+    {
+        phases[i] = 2 * (std::abs(phases[i]) - 0.5f);
+    }
+}
+
+void triangleOSC::setWavetables(const WavetableSet* tables){
+    setWavetable(tables != nullptr ? &tables->triangle : nullptr);
+}
+
+void triangleOSC::setMathAccuracy(MathAccuracy accuracy){
+    mathAccuracy = accuracy;
+    saw.setMathAccuracy(accuracy);
+}
+
+void triangleOSC::setPhase(float p){
+    Oscillator::setPhase(p);
+    saw.setPhase(p);
+}
+
+void triangleOSC::setFixedPointPhase(bool enabled){
+    Oscillator::setFixedPointPhase(enabled);
+    saw.setFixedPointPhase(enabled);
+}
+
 float triangleOSC::process(){
     
+    if (fixedPointPhase)
+    {
+        float output;
+        triangleOSC::process(&output, 1);
+        return output;
+    }
+    
+    if (wavetable != nullptr)
+        return readWavetable(*wavetable);
+    
     float output;
     
     saw.setFrequency(frequency);
@@ -170,4 +855,302 @@ float triangleOSC::process(){
     return gain*output;  // Direct triangle wave without excessive warping
 }
 
+void triangleOSC::process(float* dest, int numSamples){
+    
+    if (wavetable != nullptr)
+    {
+        renderWavetable(*wavetable, dest, numSamples);
+        return;
+    }
+    
+    // render the sawtooth block first, then fold it with the triangle's own phase
+    saw.setFrequency(frequency);
+    saw.setSampleRate(sampleRate);
+    saw.process(dest, numSamples);
+    
+    if (fixedPointPhase)
+    {
+        std::uint32_t acc = phaseAccumulator;
+        
+        for (int i = 0; i < numSamples; i++)
+        {
+            float output = (acc < 0x80000000u) ? -dest[i] : dest[i]; // phase < 0.5
+            output = 2 * (output - 0.5);
+            acc += phaseIncrement;
+            dest[i] = gain*output;
+        }
+        
+        phaseAccumulator = acc;
+        phase = toPhase(acc);
+        return;
+    }
+    
+    phaseDelta = frequency / sampleRate;
+    float p = phase;
+    
+    for (int i = 0; i < numSamples; i++)
+    {
+        float output = (p < 0.5) ? -dest[i] : dest[i];
+        output = 2 * (output - 0.5);  // Scale to range [-1, 1] from [0, 1]
+        p += phaseDelta;
+        
+        if (p > 1)
+        {
+            p -= 1;
+        }
+        
+        dest[i] = gain*output;
+    }
+    
+    phase = p;
+}
+
+// PolyBLEP residual for a downward jump of 2 at phase 0, two samples wide
+static float polyBlep(float t, float dt){
+    if (t < dt)
+    {
+        t /= dt;
+        return t + t - t*t - 1;
+    }
+    if (t > 1 - dt)
+    {
+        t = (t - 1) / dt;
+        return t*t + t + t + 1;
+    }
+    return 0;
+}
+
+// PolyBLAMP residual for a change of slope at phase 0, the integral of the BLEP
+static float polyBlamp(float t, float dt){
+    if (t < dt)
+    {
+        t = t / dt - 1;
+        return -t*t*t / 3;
+    }
+    if (t > 1 - dt)
+    {
+        t = (t - 1) / dt + 1;
+        return t*t*t / 3;
+    }
+    return 0;
+}
+
+static float wrapPhase(float p){
+    return p >= 1 ? p - 1 : p;
+}
+
+float blepSawOSC::shape(float phase, float phaseDelta){
+    return 2*phase - 1 - polyBlep(phase, phaseDelta);
+}
+
+float blepSawOSC::process(){
+    
+    if (fixedPointPhase)
+    {
+        float output;
+        blepSawOSC::process(&output, 1);
+        return output;
+    }
+    
+    phaseDelta = frequency/sampleRate;
+    float output = shape(phase, phaseDelta);
+    phase += phaseDelta;
+    
+    if (phase > 1)
+    {
+        phase -= 1;
+    }
+    
+    return gain*output;
+}
+
+void blepSawOSC::process(float* dest, int numSamples){
+    
+    if (fixedPointPhase)
+    {
+        renderPhases(dest, numSamples); // sets phaseDelta
+        
+        for (int i = 0; i < numSamples; i++)
+        {
+            dest[i] = gain*shape(dest[i], phaseDelta);
+        }
+        return;
+    }
+    
+    phaseDelta = frequency/sampleRate;
+    float p = phase;
+    
+    for (int i = 0; i < numSamples; i++)
+    {
+        float output = shape(p, phaseDelta);
+        p += phaseDelta;
+        
+        if (p > 1)
+        {
+            p -= 1;
+        }
+        
+        dest[i] = gain*output;
+    }
+    
+    phase = p;
+}
+
+float blepPulseOSC::shape(float phase, float phaseDelta, float width){
+    // up at phase 0, down at the pulse width
+    float output = phase < width ? 1.0f : -1.0f;
+    return output + polyBlep(phase, phaseDelta) - polyBlep(wrapPhase(phase + 1 - width), phaseDelta);
+}
+
+void blepPulseOSC::setPulseWidth(float width){
+    pulseWidth = std::clamp(width, 0.01f, 0.99f);
+}
+
+float blepPulseOSC::process(){
+    
+    if (fixedPointPhase)
+    {
+        float output;
+        blepPulseOSC::process(&output, 1);
+        return output;
+    }
+    
+    phaseDelta = frequency/sampleRate;
+    float output = shape(phase, phaseDelta, pulseWidth);
+    phase += phaseDelta;
+    
+    if (phase > 1)
+    {
+        phase -= 1;
+    }
+    
+    return gain*output;
+}
+
+void blepPulseOSC::process(float* dest, int numSamples){
+    
+    if (fixedPointPhase)
+    {
+        renderPhases(dest, numSamples); // sets phaseDelta
+        
+        for (int i = 0; i < numSamples; i++)
+        {
+            dest[i] = gain*shape(dest[i], phaseDelta, pulseWidth);
+        }
+        return;
+    }
+    
+    phaseDelta = frequency/sampleRate;
+    float p = phase;
+    
+    for (int i = 0; i < numSamples; i++)
+    {
+        float output = shape(p, phaseDelta, pulseWidth);
+        p += phaseDelta;
+        
+        if (p > 1)
+        {
+            p -= 1;
+        }
+        
+        dest[i] = gain*output;
+    }
+    
+    phase = p;
+}
+
+void blepPulseOSC::process(float* dest, int numSamples, const float* widths){
+    
+    if (fixedPointPhase)
+    {
+        renderPhases(dest, numSamples);
+        
+        for (int i = 0; i < numSamples; i++)
+        {
+            dest[i] = gain*shape(dest[i], phaseDelta, std::clamp(widths[i], 0.01f, 0.99f));
+        }
+        
+        if (numSamples > 0)
+            setPulseWidth(widths[numSamples - 1]);
+        return;
+    }
+    
+    phaseDelta = frequency/sampleRate;
+    float p = phase;
+    
+    for (int i = 0; i < numSamples; i++)
+    {
+        float output = shape(p, phaseDelta, std::clamp(widths[i], 0.01f, 0.99f));
+        p += phaseDelta;
+        
+        if (p > 1)
+        {
+            p -= 1;
+        }
+        
+        dest[i] = gain*output;
+    }
+    
+    phase = p;
+    if (numSamples > 0)
+        setPulseWidth(widths[numSamples - 1]);
+}
+
+float blampTriangleOSC::shape(float phase, float phaseDelta){
+    // -1 at phase 0, 1 at phase 0.5, the slope turns by 8 at both corners
+    float output = 1 - 2*std::abs(2*phase - 1);
+    return output + 4*phaseDelta*(polyBlamp(phase, phaseDelta) - polyBlamp(wrapPhase(phase + 0.5f), phaseDelta));
+}
 
+float blampTriangleOSC::process(){
+    
+    if (fixedPointPhase)
+    {
+        float output;
+        blampTriangleOSC::process(&output, 1);
+        return output;
+    }
+    
+    phaseDelta = frequency/sampleRate;
+    float output = shape(phase, phaseDelta);
+    phase += phaseDelta;
+    
+    if (phase > 1)
+    {
+        phase -= 1;
+    }
+    
+    return gain*output;
+}
+
+void blampTriangleOSC::process(float* dest, int numSamples){
+    
+    if (fixedPointPhase)
+    {
+        renderPhases(dest, numSamples); // sets phaseDelta
+        
+        for (int i = 0; i < numSamples; i++)
+        {
+            dest[i] = gain*shape(dest[i], phaseDelta);
+        }
+        return;
+    }
+    
+    phaseDelta = frequency/sampleRate;
+    float p = phase;
+    
+    for (int i = 0; i < numSamples; i++)
+    {
+        float output = shape(p, phaseDelta);
+        p += phaseDelta;
+        
+        if (p > 1)
+        {
+            p -= 1;
+        }
+        
+        dest[i] = gain*output;
+    }
+    
+    phase = p;
+}
@@ -12,6 +12,9 @@
 
 #include <vector>
 #include <ctime>
+#include <cstdint>
+#include "Wavetable.h"
+#include "FastMath.h"
 
 // Base class
 class Oscillator{
@@ -24,50 +27,138 @@ public:
     void setSampleRate(float sr);
     void setFrequency(float f);
     void setGain(float g);
-    void setPhase(float p);
+    virtual void setPhase(float p); // composite oscillators move their embedded ones along
+    virtual void setFixedPointPhase(bool enabled); // drift-free mode for long runs and very slow rates, see phaseAccumulator
+    virtual void setWavetables(const WavetableSet* tables); // read the waveshape from baked tables, nullptr to compute it
+    virtual void setMathAccuracy(MathAccuracy accuracy); // how a computed waveshape evaluates sin/tanh/pow
     
     virtual float process() = 0; // Virtual process() method to override
+    virtual void process(float* dest, int numSamples); // Render a whole block, one virtual call per block
     
 protected:
+    void setWavetable(const Wavetable* table);
+    float readWavetable(const Wavetable& table); // one sample from a table at the current phase
+    void renderWavetable(const Wavetable& table, float* dest, int numSamples);
+    void updateWavetableLevel();
+    void renderPhases(float* dest, int numSamples); // the phase at every sample of the block, advancing it
+    void advancePhase(int numSamples); // skip numSamples without rendering
+    void updatePhaseIncrement();
+    
+    const Wavetable* wavetable = nullptr; // table for this waveshape, if set
+    int wavetableLevel = 0; // mip level matching the current frequency
+    
     float frequency;
     float sampleRate;
     float phase = 0.0f;
     float phaseDelta;
     float gain;
+    MathAccuracy mathAccuracy = MathAccuracy::Exact;
+    
+    // Fixed-point phase: 2^32 is one cycle, so the accumulator wraps exactly by unsigned
+    // overflow. The increment is rounded once from frequency/sampleRate in double
+    // precision, where a float phase near 1 rounds increments of 1e-7 and less away.
+    // `phase` follows the accumulator, for the code that reads it
+    bool fixedPointPhase = false;
+    std::uint32_t phaseAccumulator = 0;
+    std::uint32_t phaseIncrement = 0;
+    static constexpr double fixedPointScale = 4294967296.0; // 2^32
+    static float toPhase(std::uint32_t accumulator) { return (float) accumulator * (float) (1.0 / fixedPointScale); }
     
 };
 
-// Sub classes
-class sineOSC : public Oscillator {
+// Sub classes, final so calls through a concrete type are resolved at compile time
+class sineOSC final : public Oscillator {
 public:
     float process() override;
+    void process(float* dest, int numSamples) override;
+    void setWavetables(const WavetableSet* tables) override;
+    static float shape(float phase); // waveshape for a phase in [0, 1], for callers that track the phase themselves
+    static void shape(float* phases, int numSamples, MathAccuracy accuracy); // in place over a block, computed in the tier
+private:
+    template <MathAccuracy accuracy>
+    void processApproximate(float* dest, int numSamples); // the High and Fast tiers
 };
 
 
-class sawOSC : public Oscillator {
+class sawOSC final : public Oscillator {
 public:
     // defaut sawOSC class
     float process() override;
+    void process(float* dest, int numSamples) override;
     // with exponential mapping
     float process(bool exponential);      // New overload for exponential
+    void process(float* dest, int numSamples, bool exponential);
+    void setWavetables(const WavetableSet* tables) override;
+    static float shape(float phase);
+    static float shapeExponential(float phase);
+    static void shape(float* phases, int numSamples, MathAccuracy accuracy);
+    static void shapeExponential(float* phases, int numSamples, MathAccuracy accuracy);
+private:
+    template <MathAccuracy accuracy>
+    void processApproximate(float* dest, int numSamples, bool exponential);
+    const Wavetable* expWavetable = nullptr;
 };
 
-class squareOSC : public Oscillator {
+class squareOSC final : public Oscillator {
     
 public:
     float process() override;
+    void process(float* dest, int numSamples) override;
+    void setWavetables(const WavetableSet* tables) override;
+    void setMathAccuracy(MathAccuracy accuracy) override;
+    void setPhase(float p) override; // and the embedded sine's
+    void setFixedPointPhase(bool enabled) override;
+    static float shape(float phase);
+    static void shape(float* phases, int numSamples, MathAccuracy accuracy);
 private:
+    template <MathAccuracy accuracy>
+    void processApproximate(float* dest, int numSamples);
     sineOSC sine;
     
 };
 
-class triangleOSC : public Oscillator {
+class triangleOSC final : public Oscillator {
 public:
     float process() override;
+    void process(float* dest, int numSamples) override;
+    void setWavetables(const WavetableSet* tables) override;
+    void setMathAccuracy(MathAccuracy accuracy) override; // of the embedded saw
+    void setPhase(float p) override; // and the embedded saw's
+    void setFixedPointPhase(bool enabled) override;
+    static float shape(float phase);
+    static void shape(float* phases, int numSamples, MathAccuracy accuracy);
 private:
     sawOSC saw;
 };
 
+// Band-limited by polynomial corrections at the discontinuities (PolyBLEP) or
+// at the corners (PolyBLAMP), cheap enough to compute per sample and never
+// reading wavetables. The shapes take the phase increment to size the corrections.
+class blepSawOSC final : public Oscillator {
+public:
+    float process() override;
+    void process(float* dest, int numSamples) override;
+    static float shape(float phase, float phaseDelta);
+};
+
+class blepPulseOSC final : public Oscillator {
+public:
+    void setPulseWidth(float width); // 0 ~ 1, 0.5 is a square
+    float process() override;
+    void process(float* dest, int numSamples) override;
+    void process(float* dest, int numSamples, const float* widths); // pulse-width modulation, one width per sample
+    static float shape(float phase, float phaseDelta, float width);
+private:
+    float pulseWidth = 0.5f;
+};
+
+class blampTriangleOSC final : public Oscillator {
+public:
+    float process() override;
+    void process(float* dest, int numSamples) override;
+    static float shape(float phase, float phaseDelta);
+};
+
     
 
 
@@ -0,0 +1,72 @@
+/*
+  ==============================================================================
+
+    OutputStage.cpp
+    Block-based output stage: the panned mix of the drone voices, one per
+    output channel, a DC blocker and the limiter, run on whole buffers.
+    Created: 17 Oct 2026 10:02:47pm
+    Author:  chenzuyu
+
+  ==============================================================================
+*/
+
+#include "OutputStage.h"
+
+OutputStage::OutputStage()
+{
+    limiter.setThreshold(ceiling);
+    limiter.setRelease(100.0f);
+}
+
+void OutputStage::prepare(const juce::dsp::ProcessSpec& spec)
+{
+    *dcBlocker.state = *juce::dsp::IIR::Coefficients<float>::makeFirstOrderHighPass(spec.sampleRate, dcCutoff);
+    dcBlocker.prepare(spec);
+    limiter.prepare(spec);
+    
+    int numChannels = juce::jmin(maxChannels, (int) spec.numChannels);
+    for (int c = 0; c < numChannels; c++)
+        panAxis[c] = 0.25f * std::cos(juce::MathConstants<float>::twoPi * c / numChannels);
+}
+
+void OutputStage::reset()
+{
+    dcBlocker.reset();
+    limiter.reset();
+}
+
+void OutputStage::setCeiling(float thresholdDecibels)
+{
+    ceiling = thresholdDecibels;
+    limiter.setThreshold(ceiling);
+}
+
+void OutputStage::mixPanned(float* const* outputs, const float* const* voices, int numChannels,
+                            const float* modulator, float* gainScratch, int numSamples) const
+{
+    for (int c = 0; c < juce::jmin(maxChannels, numChannels); c++)
+    {
+        // gain: 0.25*modulator*cos + 0.25, for stereo 0.25*m + 0.25 and 0.25 - 0.25*m
+        juce::FloatVectorOperations::multiply(gainScratch, modulator, panAxis[c], numSamples);
+        juce::FloatVectorOperations::add(gainScratch, 0.25f, numSamples);
+
+        if (panLaw == PanLaw::ConstantPower)
+        {
+            // sqrt(0.25*g) keeps the summed power constant as the pattern swings
+            for (int i = 0; i < numSamples; i++)
+                gainScratch[i] = 0.5f * std::sqrt(gainScratch[i]);
+        }
+
+        juce::FloatVectorOperations::multiply(outputs[c], voices[c], gainScratch, numSamples);
+    }
+}
+
+void OutputStage::process(juce::AudioBuffer<float>& buffer)
+{
+    juce::dsp::AudioBlock<float> block(buffer);
+    juce::dsp::ProcessContextReplacing<float> context(block);
+
+    // the limiter goes last so nothing after it can push past the ceiling
+    dcBlocker.process(context);
+    limiter.process(context);
+}
@@ -0,0 +1,57 @@
+/*
+  ==============================================================================
+
+    OutputStage.h
+    Block-based output stage: the panned mix of the drone voices, one per
+    output channel, a DC blocker and the limiter, run on whole buffers.
+    Created: 17 Oct 2026 10:02:47pm
+    Author:  chenzuyu
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <JuceHeader.h>
+#include <juce_dsp/juce_dsp.h>
+
+// How the balance modulator spreads the gain over the channels
+enum class PanLaw {
+    Linear,        // gains sum to a constant, the original stereo balance
+    ConstantPower  // squared gains sum to a constant
+};
+
+class OutputStage
+{
+public:
+    OutputStage();
+
+    static constexpr int maxChannels = 16;
+
+    void prepare(const juce::dsp::ProcessSpec& spec); // spec.numChannels sets the speaker ring
+    void reset();
+    void setCeiling(float thresholdDecibels); // limiter threshold
+    void setPanLaw(PanLaw newPanLaw) { panLaw = newPanLaw; }
+
+    // Mix one voice per channel with a 0.5 output gain, panned by the modulator in -1 ~ 1.
+    // The channels sit evenly around a ring and the modulator swings a first-order
+    // (cardioid) pattern along the axis of channel 0: channel c gets
+    // 0.25 + 0.25*modulator*cos(2*pi*c/N), or its constant power version. For stereo
+    // this is the original balance: left 0.5*b, right 0.5*(1 - b), b = 0.5 + 0.5*modulator.
+    // gainScratch needs numSamples floats.
+    void mixPanned(float* const* outputs, const float* const* voices, int numChannels,
+                   const float* modulator, float* gainScratch, int numSamples) const;
+
+    // DC blocker then limiter on every channel of the buffer, in place
+    void process(juce::AudioBuffer<float>& buffer);
+
+private:
+    using DCBlocker = juce::dsp::ProcessorDuplicator<juce::dsp::IIR::Filter<float>, juce::dsp::IIR::Coefficients<float>>;
+
+    DCBlocker dcBlocker;
+    juce::dsp::Limiter<float> limiter;
+    float ceiling = -1.0f;
+    float dcCutoff = 10.0f; // Hz
+
+    PanLaw panLaw = PanLaw::Linear;
+    float panAxis[maxChannels] = {}; // 0.25*cos(2*pi*c/N) per channel
+};
@@ -0,0 +1,131 @@
+/*
+  ==============================================================================
+
+    PerformanceMonitor.cpp
+    Per-block timing of processBlock: wall time per block and per stage, pushed
+    into a lock-free ring on the audio thread and summarised (min/avg/max/p99,
+    deadline overruns) on the thread that reads it, e.g. the editor's timer.
+    Created: 17 Oct 2026 9:14:36pm
+    Author:  chenzuyu
+
+  ==============================================================================
+*/
+
+#include "PerformanceMonitor.h"
+
+PerformanceMonitor::PerformanceMonitor()
+{
+    resetStats();
+}
+
+void PerformanceMonitor::prepare(double sr)
+{
+    sampleRate = sr;
+    std::fill(std::begin(stepTicks), std::end(stepTicks), 0);
+}
+
+void PerformanceMonitor::beginBlock()
+{
+    blockStartTicks = juce::Time::getHighResolutionTicks();
+
+    for (auto& ticks : stageTicks)
+        ticks = 0;
+}
+
+void PerformanceMonitor::endBlock(int numSamples)
+{
+    if (numSamples <= 0)
+        return;
+
+    auto endTicks = juce::Time::getHighResolutionTicks();
+    const double secondsPerTick = 1.0 / (double) juce::Time::getHighResolutionTicksPerSecond();
+
+    BlockTiming timing;
+    timing.blockSeconds = (float) ((endTicks - blockStartTicks) * secondsPerTick);
+    timing.deadlineSeconds = (float) (numSamples / sampleRate);
+    for (int s = 0; s < numStages; s++)
+        timing.stageSeconds[s] = (float) (stageTicks[s] * secondsPerTick);
+
+    // counted here so none are missed when the ring overflows
+    if (timing.blockSeconds > timing.deadlineSeconds)
+        numOverruns.fetch_add(1, std::memory_order_relaxed);
+
+    int start1, size1, start2, size2;
+    fifo.prepareToWrite(1, start1, size1, start2, size2);
+
+    if (size1 > 0)
+        ring[start1] = timing;
+    else
+        numDropped.fetch_add(1, std::memory_order_relaxed);
+
+    fifo.finishedWrite(size1);
+}
+
+PerformanceMonitor::Stats PerformanceMonitor::getStats()
+{
+    // drain everything written since the last call
+    int start1, size1, start2, size2;
+    fifo.prepareToRead(fifo.getNumReady(), start1, size1, start2, size2);
+
+    double newLoadSum = 0.0;
+    int numNew = size1 + size2;
+
+    for (int block = 0; block < numNew; block++)
+    {
+        const auto& timing = ring[block < size1 ? start1 + block : start2 + block - size1];
+        float load = timing.blockSeconds / timing.deadlineSeconds;
+
+        histogram[juce::jlimit(0, numBuckets - 1, (int) (load * bucketsPerUnit))]++;
+        minLoad = numBlocks == 0 ? load : juce::jmin(minLoad, load);
+        maxLoad = juce::jmax(maxLoad, load);
+        loadSum += load;
+        newLoadSum += load;
+        numBlocks++;
+
+        for (int s = 0; s < numStages; s++)
+            stageLoadSum[s] += timing.stageSeconds[s] / timing.deadlineSeconds;
+    }
+
+    fifo.finishedRead(numNew);
+
+    Stats stats;
+    stats.numBlocks = numBlocks;
+    stats.numOverruns = numOverruns.load(std::memory_order_relaxed) - overrunsAtReset;
+    stats.numDropped = numDropped.load(std::memory_order_relaxed) - droppedAtReset;
+
+    if (numBlocks == 0)
+        return stats;
+
+    stats.currentLoad = numNew > 0 ? (float) (newLoadSum / numNew) : 0.0f;
+    stats.minLoad = minLoad;
+    stats.maxLoad = maxLoad;
+    stats.averageLoad = (float) (loadSum / numBlocks);
+    for (int s = 0; s < numStages; s++)
+        stats.stageLoad[s] = (float) (stageLoadSum[s] / numBlocks);
+
+    // upper edge of the bucket holding the 99th percentile
+    juce::int64 target = (99 * numBlocks + 99) / 100;
+    juce::int64 count = 0;
+    for (int bucket = 0; bucket < numBuckets; bucket++)
+    {
+        count += histogram[bucket];
+        if (count >= target)
+        {
+            stats.p99Load = juce::jmin(maxLoad, (float) (bucket + 1) / bucketsPerUnit);
+            break;
+        }
+    }
+
+    return stats;
+}
+
+void PerformanceMonitor::resetStats()
+{
+    std::fill(std::begin(histogram), std::end(histogram), 0);
+    std::fill(std::begin(stageLoadSum), std::end(stageLoadSum), 0.0);
+    numBlocks = 0;
+    loadSum = 0.0;
+    minLoad = maxLoad = 0.0f;
+    overrunsAtReset = numOverruns.load(std::memory_order_relaxed);
+    droppedAtReset = numDropped.load(std::memory_order_relaxed);
+}
@@ -0,0 +1,162 @@
+/*
+  ==============================================================================
+
+    PerformanceMonitor.h
+    Per-block timing of processBlock: wall time per block and per stage, pushed
+    into a lock-free ring on the audio thread and summarised (min/avg/max/p99,
+    deadline overruns) on the thread that reads it, e.g. the editor's timer.
+    Created: 17 Oct 2026 9:14:36pm
+    Author:  chenzuyu
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <JuceHeader.h>
+
+// Set to 0 to compile the timing out of processBlock altogether
+#ifndef DRONE_PERF_MONITOR
+ #define DRONE_PERF_MONITOR 1
+#endif
+
+// Set to 1 to also time the steps inside the stages, DroneBench does
+#ifndef DRONE_BENCH_STAGES
+ #define DRONE_BENCH_STAGES 0
+#endif
+
+class PerformanceMonitor
+{
+public:
+    enum Stage
+    {
+        synthStage,  // drone and MIDI voices: oscillators, LFOs, filters
+        delayStage,  // modulators, the delay lines and the reverb
+        outputStage, // panned mix and the limiter
+        numStages
+    };
+
+    // The steps of processBlock one by one, for the benchmark
+    enum Step
+    {
+        modulatorStep,  // modulation sources and the matrix
+        droneVoiceStep, // the voice bank, with the oversampling around it
+        midiVoiceStep,
+        delayLineStep,
+        reverbStep,
+        outputMixStep,  // panned mix
+        limiterStep,    // DC blocker and limiter
+        numSteps
+    };
+
+    // One block, as written by the audio thread
+    struct BlockTiming
+    {
+        float blockSeconds = 0.0f;
+        float deadlineSeconds = 0.0f; // numSamples / sampleRate
+        float stageSeconds[numStages] = {};
+    };
+
+    // Summary since the last resetStats(), loads are block time / deadline (1 = 100%)
+    struct Stats
+    {
+        float currentLoad = 0.0f; // average over the blocks read by the last getStats() call
+        float minLoad = 0.0f;
+        float averageLoad = 0.0f;
+        float maxLoad = 0.0f;
+        float p99Load = 0.0f;
+        float stageLoad[numStages] = {}; // average share of the deadline per stage
+        juce::int64 numBlocks = 0;
+        juce::int64 numOverruns = 0; // blocks that took longer than their deadline
+        juce::int64 numDropped = 0;  // blocks lost because the ring was full
+    };
+
+    PerformanceMonitor();
+
+    void prepare(double sampleRate);
+
+    // Audio thread
+    void beginBlock();
+    void endBlock(int numSamples);
+    void addStageTicks(Stage stage, juce::int64 ticks) { stageTicks[stage] += ticks; }
+    void addStepTicks(Step step, juce::int64 ticks) { stepTicks[step] += ticks; }
+
+    // Total time per step since prepare(). Plain counters, read them while processBlock is not running
+    double getStepSeconds(Step step) const { return juce::Time::highResolutionTicksToSeconds(stepTicks[step]); }
+
+    // Reader thread, one at a time: drain the ring into the histogram and summarise
+    Stats getStats();
+    void resetStats();
+
+    static constexpr bool isEnabled() { return DRONE_PERF_MONITOR != 0; }
+    static constexpr bool hasSteps() { return DRONE_BENCH_STAGES != 0; }
+
+    // Times the enclosing scope, use through the macros below
+    struct ScopedBlock
+    {
+        ScopedBlock(PerformanceMonitor& m, int n) : monitor(m), numSamples(n) { monitor.beginBlock(); }
+        ~ScopedBlock() { monitor.endBlock(numSamples); }
+        PerformanceMonitor& monitor;
+        int numSamples;
+    };
+
+    struct ScopedStage
+    {
+        ScopedStage(PerformanceMonitor& m, Stage s) : monitor(m), stage(s), startTicks(juce::Time::getHighResolutionTicks()) {}
+        ~ScopedStage() { monitor.addStageTicks(stage, juce::Time::getHighResolutionTicks() - startTicks); }
+        PerformanceMonitor& monitor;
+        Stage stage;
+        juce::int64 startTicks;
+    };
+
+    struct ScopedStep
+    {
+        ScopedStep(PerformanceMonitor& m, Step s) : monitor(m), step(s), startTicks(juce::Time::getHighResolutionTicks()) {}
+        ~ScopedStep() { monitor.addStepTicks(step, juce::Time::getHighResolutionTicks() - startTicks); }
+        PerformanceMonitor& monitor;
+        Step step;
+        juce::int64 startTicks;
+    };
+
+private:
+    double sampleRate = 44100.0;
+
+    // audio thread state
+    juce::int64 blockStartTicks = 0;
+    juce::int64 stageTicks[numStages] = {};
+    juce::int64 stepTicks[numSteps] = {};
+    std::atomic<juce::int64> numOverruns { 0 };
+    std::atomic<juce::int64> numDropped { 0 };
+
+    // single producer, single consumer ring of block timings
+    static constexpr int ringSize = 1024;
+    juce::AbstractFifo fifo { ringSize };
+    BlockTiming ring[ringSize];
+
+    // reader state: loads from 0 to maxLoad in steps of 1/bucketsPerUnit
+    static constexpr int bucketsPerUnit = 200;
+    static constexpr int numBuckets = 4 * bucketsPerUnit;
+    juce::int64 histogram[numBuckets] = {};
+    juce::int64 numBlocks = 0;
+    double loadSum = 0.0;
+    double stageLoadSum[numStages] = {};
+    float minLoad = 0.0f;
+    float maxLoad = 0.0f;
+    juce::int64 overrunsAtReset = 0;
+    juce::int64 droppedAtReset = 0;
+
+    JUCE_DECLARE_NON_COPYABLE (PerformanceMonitor)
+};
+
+#if DRONE_PERF_MONITOR
+ #define DRONE_PERF_BLOCK(monitor, numSamples) PerformanceMonitor::ScopedBlock perfBlock (monitor, numSamples)
+ #define DRONE_PERF_STAGE(monitor, stage) PerformanceMonitor::ScopedStage perfStage (monitor, PerformanceMonitor::stage)
+#else
+ #define DRONE_PERF_BLOCK(monitor, numSamples)
+ #define DRONE_PERF_STAGE(monitor, stage)
+#endif
+
+#if DRONE_BENCH_STAGES
+ #define DRONE_BENCH_STEP(monitor, step) PerformanceMonitor::ScopedStep benchStep (monitor, PerformanceMonitor::step)
+#else
+ #define DRONE_BENCH_STEP(monitor, step)
+#endif
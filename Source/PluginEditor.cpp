@@ -16,10 +16,15 @@ DroneAudioProcessorEditor::DroneAudioProcessorEditor (DroneAudioProcessor& p)
     // Make sure that before the constructor has finished, you've set the
     // editor's size to whatever you need it to be.
     setSize (400, 300);
+    
+    // refresh the CPU meter
+    if (PerformanceMonitor::isEnabled())
+        startTimerHz (10);
 }
 
 DroneAudioProcessorEditor::~DroneAudioProcessorEditor()
 {
+    stopTimer();
 }
 
 //==============================================================================
@@ -31,6 +36,53 @@ void DroneAudioProcessorEditor::paint (juce::Graphics& g)
     g.setColour (juce::Colours::white);
     g.setFont (juce::FontOptions (15.0f));
     g.drawFittedText ("Hello World!", getLocalBounds(), juce::Justification::centred, 1);
+    
+    paintCpuMeter (g, getLocalBounds().removeFromBottom (60).reduced (10));
+}
+
+void DroneAudioProcessorEditor::paintCpuMeter (juce::Graphics& g, juce::Rectangle<int> area)
+{
+    g.setFont (juce::FontOptions (12.0f));
+    
+    if (! PerformanceMonitor::isEnabled())
+    {
+        g.setColour (juce::Colours::grey);
+        g.drawFittedText ("CPU meter compiled out", area, juce::Justification::centredLeft, 1);
+        return;
+    }
+    
+    // load of the last blocks against their deadline, the p99 as a tick
+    auto bar = area.removeFromTop (12);
+    g.setColour (juce::Colours::darkgrey);
+    g.fillRect (bar);
+    
+    auto load = juce::jlimit (0.0f, 1.0f, perfStats.currentLoad);
+    g.setColour (load < 0.5f ? juce::Colours::green : (load < 0.8f ? juce::Colours::orange : juce::Colours::red));
+    g.fillRect (bar.withWidth (juce::roundToInt (bar.getWidth() * load)));
+    
+    g.setColour (juce::Colours::white);
+    auto p99X = bar.getX() + juce::roundToInt (bar.getWidth() * juce::jlimit (0.0f, 1.0f, perfStats.p99Load));
+    g.drawVerticalLine (p99X, (float) bar.getY(), (float) bar.getBottom());
+    
+    auto percent = [] (float load) { return juce::String (100.0f * load, 1) + "%"; };
+    
+    g.drawFittedText ("CPU " + percent (perfStats.currentLoad)
+                        + "  avg " + percent (perfStats.averageLoad)
+                        + "  p99 " + percent (perfStats.p99Load)
+                        + "  max " + percent (perfStats.maxLoad)
+                        + "  overruns " + juce::String (perfStats.numOverruns),
+                      area.removeFromTop (20), juce::Justification::centredLeft, 1);
+    
+    g.drawFittedText ("synth " + percent (perfStats.stageLoad[PerformanceMonitor::synthStage])
+                        + "  delay " + percent (perfStats.stageLoad[PerformanceMonitor::delayStage])
+                        + "  output " + percent (perfStats.stageLoad[PerformanceMonitor::outputStage]),
+                      area, juce::Justification::centredLeft, 1);
+}
+
+void DroneAudioProcessorEditor::timerCallback()
+{
+    perfStats = audioProcessor.getPerformanceMonitor().getStats();
+    repaint();
 }
 
 void DroneAudioProcessorEditor::resized()
@@ -15,7 +15,8 @@
 //==============================================================================
 /**
 */
-class DroneAudioProcessorEditor  : public juce::AudioProcessorEditor
+class DroneAudioProcessorEditor  : public juce::AudioProcessorEditor,
+                                   private juce::Timer
 {
 public:
     DroneAudioProcessorEditor (DroneAudioProcessor&);
@@ -26,9 +27,16 @@ public:
     void resized() override;
 
 private:
+    void timerCallback() override;
+    void paintCpuMeter (juce::Graphics&, juce::Rectangle<int> area);
+    
+
     // This reference is provided as a quick way for your editor to
     // access the processor object that created it.
     DroneAudioProcessor& audioProcessor;
     
+    // Latest summary from the processor's performance monitor
+    PerformanceMonitor::Stats perfStats;
+    
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (DroneAudioProcessorEditor)
 };
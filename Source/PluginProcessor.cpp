@@ -21,89 +21,695 @@ DroneAudioProcessor::DroneAudioProcessor()
                       #endif
                        .withOutput ("Output", juce::AudioChannelSet::stereo(), true)
                      #endif
-                       )
+                       ),
+#else
+     :
 #endif
+       apvts (*this, nullptr, "Parameters", createParameterLayout())
 {
+    frequencyParam = apvts.getRawParameterValue ("frequency");
+    oscTypeParam = apvts.getRawParameterValue ("oscType");
+    pulseWidthParam = apvts.getRawParameterValue ("pulseWidth");
+    pulseWidthModParam = apvts.getRawParameterValue ("pulseWidthMod");
+    waveshapesParam = apvts.getRawParameterValue ("waveshapes");
+    unisonVoicesParam = apvts.getRawParameterValue ("unisonVoices");
+    unisonDetuneParam = apvts.getRawParameterValue ("unisonDetune");
+    unisonWidthParam = apvts.getRawParameterValue ("unisonWidth");
+    lfoTypeParam = apvts.getRawParameterValue ("lfoType");
+    lfoRateParam = apvts.getRawParameterValue ("lfoRate");
+    lfoDepthParam = apvts.getRawParameterValue ("lfoDepth");
+    filterTypeParam = apvts.getRawParameterValue ("filterType");
+    cutoffParam = apvts.getRawParameterValue ("cutoff");
+    resonanceParam = apvts.getRawParameterValue ("resonance");
+    delayInterpolationParam = apvts.getRawParameterValue ("delayInterpolation");
+    panLawParam = apvts.getRawParameterValue ("panLaw");
+    workerThreadsParam = apvts.getRawParameterValue ("workerThreads");
+    oversamplingParam = apvts.getRawParameterValue ("oversampling");
+    oversamplingFilterParam = apvts.getRawParameterValue ("oversamplingFilter");
+    modSineRateParam = apvts.getRawParameterValue ("modSineRate");
+    cutoffModSourceParam = apvts.getRawParameterValue ("cutoffModSource");
+    cutoffModAmountParam = apvts.getRawParameterValue ("cutoffModAmount");
+    reverbMixParam = apvts.getRawParameterValue ("reverbMix");
+    reverbDecayParam = apvts.getRawParameterValue ("reverbDecay");
+    reverbDampingParam = apvts.getRawParameterValue ("reverbDamping");
+    tempoSyncParam = apvts.getRawParameterValue ("tempoSync");
+    syncCycleParam = apvts.getRawParameterValue ("syncCycle");
+    syncDelayParam = apvts.getRawParameterValue ("syncDelay");
+    
+    setUpModulation();
+    
+    // picks up latency changes made on the audio thread
+    startTimerHz(10);
 }
 DroneAudioProcessor::~DroneAudioProcessor()
 {
+    stopTimer();
+}
+
+juce::AudioProcessorValueTreeState::ParameterLayout DroneAudioProcessor::createParameterLayout()
+{
+    juce::AudioProcessorValueTreeState::ParameterLayout layout;
+    
+    // drone voice
+    layout.add (std::make_unique<juce::AudioParameterFloat> (juce::ParameterID { "frequency", 1 }, "Frequency",
+                                                             juce::NormalisableRange<float> (20.0f, 2000.0f, 0.0f, 0.3f), 110.0f));
+    // in the order of OscType
+    layout.add (std::make_unique<juce::AudioParameterChoice> (juce::ParameterID { "oscType", 1 }, "Oscillator",
+                                                              juce::StringArray { "Saw", "Square", "Triangle",
+                                                                                  "BLEP Saw", "BLEP Square", "BLEP Pulse", "BLAMP Triangle" }, 1));
+    layout.add (std::make_unique<juce::AudioParameterFloat> (juce::ParameterID { "pulseWidth", 1 }, "Pulse Width",
+                                                             juce::NormalisableRange<float> (0.05f, 0.95f), 0.25f));
+    layout.add (std::make_unique<juce::AudioParameterFloat> (juce::ParameterID { "pulseWidthMod", 1 }, "Pulse Width Mod",
+                                                             juce::NormalisableRange<float> (0.0f, 0.45f), 0.2f));
+    
+    // how the oscillators and LFOs make their waveshapes: baked tables, or computed in a MathAccuracy tier
+    layout.add (std::make_unique<juce::AudioParameterChoice> (juce::ParameterID { "waveshapes", 1 }, "Waveshapes",
+                                                              juce::StringArray { "Wavetables", "Exact", "High", "Fast" }, 0));
+    
+    // unison: detuned saws stacked in place of the oscillator, on the drone and the MIDI voices
+    layout.add (std::make_unique<juce::AudioParameterInt> (juce::ParameterID { "unisonVoices", 1 }, "Unison Voices",
+                                                           1, UnisonOscillator::maxVoices, 1));
+    layout.add (std::make_unique<juce::AudioParameterFloat> (juce::ParameterID { "unisonDetune", 1 }, "Unison Detune",
+                                                             juce::NormalisableRange<float> (0.0f, 100.0f), 25.0f));
+    layout.add (std::make_unique<juce::AudioParameterFloat> (juce::ParameterID { "unisonWidth", 1 }, "Unison Width",
+                                                             juce::NormalisableRange<float> (0.0f, 1.0f), 1.0f));
+    
+    // cutoff LFO
+    layout.add (std::make_unique<juce::AudioParameterChoice> (juce::ParameterID { "lfoType", 1 }, "LFO Shape",
+                                                              juce::StringArray { "Sine", "Saw", "Square", "Triangle" }, 1));
+    layout.add (std::make_unique<juce::AudioParameterFloat> (juce::ParameterID { "lfoRate", 1 }, "LFO Rate",
+                                                             juce::NormalisableRange<float> (0.01f, 20.0f, 0.0f, 0.3f), 0.1f));
+    layout.add (std::make_unique<juce::AudioParameterFloat> (juce::ParameterID { "lfoDepth", 1 }, "LFO Depth",
+                                                             juce::NormalisableRange<float> (0.0f, 5000.0f, 0.0f, 0.5f), 2200.0f));
+    
+    // filter, in the order of FilterType
+    layout.add (std::make_unique<juce::AudioParameterChoice> (juce::ParameterID { "filterType", 1 }, "Filter Type",
+                                                              juce::StringArray { "Low Pass", "High Pass", "Band Pass", "All Pass",
+                                                                                  "SVF Low Pass", "SVF High Pass", "SVF Band Pass", "SVF Notch" }, 0));
+    layout.add (std::make_unique<juce::AudioParameterFloat> (juce::ParameterID { "cutoff", 1 }, "Cutoff",
+                                                             juce::NormalisableRange<float> (20.0f, 20000.0f, 0.0f, 0.25f), 2200.0f + 112.0f));
+    layout.add (std::make_unique<juce::AudioParameterFloat> (juce::ParameterID { "resonance", 1 }, "Resonance",
+                                                             juce::NormalisableRange<float> (0.1f, 10.0f, 0.0f, 0.5f), 0.7f));
+    
+    // delay, in the order of DelayInterpolation
+    layout.add (std::make_unique<juce::AudioParameterChoice> (juce::ParameterID { "delayInterpolation", 1 }, "Delay Interpolation",
+                                                              juce::StringArray { "None", "Linear", "Hermite", "Lagrange", "Allpass" }, 1));
+    
+    // output, in the order of PanLaw
+    layout.add (std::make_unique<juce::AudioParameterChoice> (juce::ParameterID { "panLaw", 1 }, "Pan Law",
+                                                              juce::StringArray { "Linear", "Constant Power" }, 0));
+    
+    // extra threads rendering the channels in parallel. The delay lines split per channel, the
+    // drone voices per SIMD group, so stereo renders them serially. Only read by prepareToPlay,
+    // so a saved setting rather than something to automate
+    layout.add (std::make_unique<juce::AudioParameterInt> (juce::ParameterID { "workerThreads", 1 }, "Worker Threads (applies on restart)",
+                                                           0, WorkerPool::maxWorkers, 0,
+                                                           juce::AudioParameterIntAttributes().withAutomatable (false)));
+    
+    // oversampling of the voices, trading CPU for aliasing
+    layout.add (std::make_unique<juce::AudioParameterChoice> (juce::ParameterID { "oversampling", 1 }, "Oversampling",
+                                                              juce::StringArray { "Off", "2x", "4x", "8x" }, 0));
+    layout.add (std::make_unique<juce::AudioParameterChoice> (juce::ParameterID { "oversamplingFilter", 1 }, "Oversampling Filter",
+                                                              juce::StringArray { "Polyphase IIR", "Linear Phase FIR" }, 0));
+    
+    // modulation matrix: the cutoff route, in the order of ModSource
+    layout.add (std::make_unique<juce::AudioParameterFloat> (juce::ParameterID { "modSineRate", 1 }, "Mod Sine Rate",
+                                                             juce::NormalisableRange<float> (0.01f, 200.0f, 0.0f, 0.3f), 5.0f));
+    layout.add (std::make_unique<juce::AudioParameterChoice> (juce::ParameterID { "cutoffModSource", 1 }, "Cutoff Mod Source",
+                                                              juce::StringArray { "Feedback Saw", "Delay Time Saw", "Balance Square", "Sine", "Voice LFO" }, 3));
+    layout.add (std::make_unique<juce::AudioParameterFloat> (juce::ParameterID { "cutoffModAmount", 1 }, "Cutoff Mod Amount",
+                                                             juce::NormalisableRange<float> (0.0f, 5000.0f, 0.0f, 0.5f), 0.0f));
+    
+    // FDN reverb on the output, skipped while the mix is 0 and cleared when it comes back
+    layout.add (std::make_unique<juce::AudioParameterFloat> (juce::ParameterID { "reverbMix", 1 }, "Reverb Mix",
+                                                             juce::NormalisableRange<float> (0.0f, 1.0f), 0.0f));
+    layout.add (std::make_unique<juce::AudioParameterFloat> (juce::ParameterID { "reverbDecay", 1 }, "Reverb Decay",
+                                                             juce::NormalisableRange<float> (0.5f, 30.0f, 0.0f, 0.4f), 6.0f));
+    layout.add (std::make_unique<juce::AudioParameterFloat> (juce::ParameterID { "reverbDamping", 1 }, "Reverb Damping",
+                                                             juce::NormalisableRange<float> (500.0f, 20000.0f, 0.0f, 0.3f), 6000.0f));
+    
+    // host tempo sync: one cycle of the feedback and delay time saws in bars, the delay time as a note value
+    layout.add (std::make_unique<juce::AudioParameterBool> (juce::ParameterID { "tempoSync", 1 }, "Tempo Sync", false));
+    layout.add (std::make_unique<juce::AudioParameterChoice> (juce::ParameterID { "syncCycle", 1 }, "Sync Mod Cycle",
+                                                              juce::StringArray { "1 Bar", "2 Bars", "4 Bars", "8 Bars",
+                                                                                  "16 Bars", "32 Bars", "64 Bars" }, 5));
+    layout.add (std::make_unique<juce::AudioParameterChoice> (juce::ParameterID { "syncDelay", 1 }, "Sync Delay",
+                                                              juce::StringArray { "1/32", "1/16", "1/8", "1/4" }, 1));
+    
+    return layout;
+}
+
+void DroneAudioProcessor::setUpModulation()
+{
+    // the routes that used to be wired into processBlock
+    modMatrix.addRoute(feedbackSaw, feedbackDestination, 1.0f);
+    
+    // variational delay time: 2000*(1 + LFO), in samples: 0 ~ 4000
+    modMatrix.setOffset(delayTimeDestination, freeDelayTime);
+    delayTimeRoute = modMatrix.addRoute(delayTimeSaw, delayTimeDestination, freeDelayTime);
+    
+    modMatrix.addRoute(balanceSquare, balanceDestination, 1.0f);
+    
+    // each voice's own LFO sweeps its cutoff, by the LFO depth
+    modMatrix.setVoiceSource(voiceLFO, true);
+    voiceLFORoute = modMatrix.addRoute(voiceLFO, cutoffDestination, 0.0f);
+    
+    // Hz on top of every voice's own cutoff, off until an amount is set
+    for (int source = 0; source < numModSources; source++)
+        cutoffRoutes[source] = modMatrix.addRoute(source, cutoffDestination, 0.0f);
 }
 
 void DroneAudioProcessor::prepareToPlay (double sampleRate, int samplesPerBlock)
 {
+    // Everything that allocates happens here, sized for what the new configuration
+    // may need. applyConfig() sets the engine up from it on the audio thread,
+    // at the top of the next block, without allocating
+    EngineConfig config;
+    config.sampleRate = sampleRate;
+    config.maxBlockSize = samplesPerBlock;
+    config.numChannels = juce::jlimit(1, maxChannels, getTotalNumOutputChannels()); // one drone voice per output channel
+    
+    // Bake the oscillator waveshapes into band-limited tables, once: they do not depend on the
+    // sample rate. Built whatever the waveshapes parameter says, it may switch to them at any block
+    if (! wavetablesBuilt)
+    {
+        wavetables.build(wavetableQuality);
+        wavetablesBuilt = true;
+    }
+    
+    // Delay memory for every channel and the reverb lines at the highest supported
+    // sample rate, a later sample rate change only lays the lines out again
+    delayArena.reserve((size_t) config.numChannels * MemoryArena::getSliceSize((size_t) Delay::getRequiredMemory(maxDelaySamples))
+                       + FDNReverb::getRequiredMemory(maxSampleRate));
+    
+    // the block buffers for the synth voices and the modulators, only ever grown
+    scratch.setSize(numModulatorChannels + 2 * config.numChannels, samplesPerBlock, false, false, true);
+    modMatrix.prepare(numModSources, numModDestinations, samplesPerBlock);
+    
+    // the channels render in parallel on these, if any, scheduled as real-time threads with the block period
+    workerPool.setNumWorkers((int) workerThreadsParam -> load(), samplesPerBlock, sampleRate);
+    
+    outputStage.prepare({ sampleRate, (juce::uint32) samplesPerBlock, (juce::uint32) getTotalNumOutputChannels() });
+    
+    // Prepare every oversampling factor and filter, switching between them
+    // in processBlock then only changes a pointer
+    for (int filter = 0; filter < numOversamplingFilters; filter++)
+    {
+        auto filterType = filter == polyphaseIIR ? juce::dsp::Oversampling<float>::filterHalfBandPolyphaseIIR
+                                                 : juce::dsp::Oversampling<float>::filterHalfBandFIREquiripple;
+        for (int factor = 1; factor < numOversamplingFactors; factor++)
+        {
+            auto& os = oversamplers[filter][factor - 1];
+            if (os == nullptr || oversamplingChannels != config.numChannels)
+                os = std::make_unique<juce::dsp::Oversampling<float>>(config.numChannels, factor, filterType, true, true);
+            os -> initProcessing((size_t) samplesPerBlock);
+        }
+    }
+    oversamplingChannels = config.numChannels;
+    oversampledVoices.setSize(config.numChannels, samplesPerBlock << (numOversamplingFactors - 1), false, false, true);
+    
+    // hosts read the latency when prepareToPlay returns, report it now rather than in applyConfig
+    int factor = (int) oversamplingParam -> load();
+    auto* os = factor > 0 ? oversamplers[(int) oversamplingFilterParam -> load()][factor - 1].get() : nullptr;
+    oversamplingLatency = os != nullptr ? juce::roundToInt(os -> getLatencyInSamples()) : 0;
+    setLatencySamples(oversamplingLatency);
+    
+    configSwap.publish(config);
+}
+
+void DroneAudioProcessor::applyConfig (const EngineConfig& config)
+{
+    double sampleRate = config.sampleRate;
+    
+    // Start the parameter ramps at the current values
+    double rampSeconds = 0.05;
+    frequency.reset(sampleRate, rampSeconds);
+    lfoRate.reset(sampleRate, rampSeconds);
+    lfoDepth.reset(sampleRate, rampSeconds);
+    cutoff.reset(sampleRate, rampSeconds);
+    resonance.reset(sampleRate, rampSeconds);
+    delayCentre.reset(sampleRate, 0.5); // slower, its per-block steps move the delay read point
+    frequency.setCurrentAndTargetValue(frequencyParam -> load());
+    lfoRate.setCurrentAndTargetValue(lfoRateParam -> load());
+    lfoDepth.setCurrentAndTargetValue(lfoDepthParam -> load());
+    cutoff.setCurrentAndTargetValue(cutoffParam -> load());
+    resonance.setCurrentAndTargetValue(resonanceParam -> load());
+    
+    auto oscType = static_cast<OscType>((int) oscTypeParam -> load());
+    auto lfoType = static_cast<LFOType>((int) lfoTypeParam -> load());
+    auto filterType = static_cast<FilterType>((int) filterTypeParam -> load());
+    
+    numDroneVoices = config.numChannels;
+    chunkSize = juce::jmax(1, juce::jmin(config.maxBlockSize, scratch.getNumSamples()));
     
     // LFO Modulated Subtractive Synthesis
     // set up parameters
-    std::vector<FilterSynth*> ptrs2Synth = {&filterSynthL, &filterSynthR};
-    for (auto* filterSynthPtr : ptrs2Synth)
+    voiceBank.setSampleRate(sampleRate);
+    voiceBank.setNumVoices(numDroneVoices);
+    
+    for (int voice = 0; voice < numDroneVoices; voice++)
     {
-        filterSynthPtr -> setSampleRate(sampleRate);
-       
+        // spread the oscillator and LFO phases evenly over the channels, for stereo 0 and 0.5
+        float phaseOffset = (float) voice / numDroneVoices;
+        
+        voiceBank.setOSC(voice, oscType, frequency.getCurrentValue(), phaseOffset);
+        voiceBank.setLFO(voice, lfoType, lfoRate.getCurrentValue(), lfoDepth.getCurrentValue(), phaseOffset);
+        voiceBank.setExponentialLFO(voice, voice % 2 == 1); // even (left): linear saw cutoff LFO, odd (right): exponential ramping LFO
+        voiceBank.setFilter(voice, filterType, cutoff.getCurrentValue(), resonance.getCurrentValue());
+        voiceBank.setPulseWidth(voice, pulseWidthParam -> load(), pulseWidthModParam -> load());
     }
-    filterSynthL.setOSC(OscType::Square, 110, 0);
-    filterSynthR.setOSC(OscType::Square, 110, 0.5);
-    filterSynthL.setLFO(LFOType::Saw, 0.1, 2200, 0);
-    filterSynthR.setLFO(LFOType::Saw, 0.1, 2200, 0.5);
-    filterSynthL.setFilter(FilterType::LowPass, 2200 + 112, 0.7);
-    filterSynthR.setFilter(FilterType::LowPass, 2200 + 112, 0.7);
+    voiceBank.setControlRate(filterControlRate);
+    
+    midiVoices.prepare(sampleRate);
+    midiVoices.setVoiceParameters(oscType, lfoType, lfoRate.getCurrentValue(), lfoDepth.getCurrentValue(),
+                                  filterType, cutoff.getCurrentValue(), resonance.getCurrentValue());
+    midiVoices.setPulseWidth(pulseWidthParam -> load(), pulseWidthModParam -> load());
+    setUnison((int) unisonVoicesParam -> load(), unisonDetuneParam -> load(), unisonWidthParam -> load());
+    
     // Set LFOs
+    Oscillator* ptrs2LFOs[] = {&saw, &square, &LFO, &sine};
+    for (auto* lfoPtr : ptrs2LFOs)
+    {
+        lfoPtr -> setFixedPointPhase(fixedPointModulators);
+    }
+    
+    // the tables or the computed tier, for the voices and the modulators alike
+    setWaveshapes((int) waveshapesParam -> load());
+    
+    saw.setSampleRate(sampleRate);    // modulating the delay feedback gain
+    square.setSampleRate(sampleRate); // modulating the left and right mixing
+    LFO.setSampleRate(sampleRate);    // modulating the delay time
+    delayCentre.setCurrentAndTargetValue(freeDelayTime);
+    setFreeRunning(); // until the first block with a tempo, if synced
     
-    saw.setFrequency(0.01);   // modulating the delay feedback gain
-    saw.setSampleRate(sampleRate);
+    sine.setFrequency(modSineRateParam -> load()); // free for the matrix routes
+    sine.setSampleRate(sampleRate);
     
-    square.setFrequency(1);   // modulating the left and right mixing
-    square.setSampleRate(sampleRate);
+    // set delay buffer size: one second, laid out in the arena reserved by prepareToPlay
+    delayArena.reset();
+    int delaySamples = (int) juce::jmin(sampleRate, maxSampleRate);
+    
+    for (int channel = 0; channel < numDroneVoices; channel++)
+    {
+        delays[channel].setMemory(delayArena.allocate((size_t) Delay::getRequiredMemory(maxDelaySamples)), maxDelaySamples);
+        delays[channel].setBufferSize(delaySamples);
         
-    LFO.setFrequency(0.01);   // modulating the delay time
-    LFO.setSampleRate(sampleRate);
+        // decorrelate the channels: each line runs up to 10% longer, spread by the golden ratio
+        float spread = channel * 0.618034f;
+        delayTimeScales[channel] = 1.0f + (maxDelayTimeScale - 1.0f) * (spread - std::floor(spread));
+    }
+    reverb.setMix(reverbMixParam -> load()); // the first block starts at the settings, not ramping to them
+    reverb.setDecayTime(reverbDecayParam -> load());
+    reverb.prepare(juce::jmin(sampleRate, maxSampleRate), maxSampleRate, delayArena);
+    
+    perfMonitor.prepare(sampleRate);
+    
+    currentSampleRate = sampleRate;
+    setOversampling((int) oversamplingParam -> load(), (int) oversamplingFilterParam -> load());
+}
+
+void DroneAudioProcessor::setUnison (int numVoices, float detuneCents, float width)
+{
+    unisonVoices = numVoices;
+    unisonDetune = detuneCents;
+    unisonWidth = width;
+    
+    for (int voice = 0; voice < numDroneVoices; voice++)
+        voiceBank.setUnison(voice, numVoices, detuneCents, width);
+    
+    midiVoices.setUnison(numVoices, detuneCents, width); // from the next note-on
+}
+
+void DroneAudioProcessor::setWaveshapes (int choice)
+{
+    // Wavetables, then the MathAccuracy tiers in order. Only pointers and flags
+    // change, the running phases carry on
+    waveshapes = choice;
+    useWavetables = choice == 0;
+    mathAccuracy = static_cast<MathAccuracy>(juce::jmax(0, choice - 1));
+    const WavetableSet* tables = useWavetables ? &wavetables : nullptr;
     
-    // set delay buffer size
+    voiceBank.setWavetables(tables);
+    voiceBank.setMathAccuracy(mathAccuracy);
+    midiVoices.setWavetables(tables);
+    midiVoices.setMathAccuracy(mathAccuracy);
     
-    std::vector<Delay*> ptr2DelayLines = {&delayL, &delayR};
-    for (auto* delayPtr : ptr2DelayLines)
+    Oscillator* modulators[] = {&saw, &square, &LFO, &sine};
+    for (auto* modulator : modulators)
     {
-        delayPtr -> setBufferSize(sampleRate);
+        modulator -> setWavetables(tables);
+        modulator -> setMathAccuracy(mathAccuracy);
     }
+}
+
+void DroneAudioProcessor::setOversampling (int factor, int filter)
+{
+    oversamplingFactor = factor;
+    oversamplingFilter = filter;
+    oversampler = factor > 0 ? oversamplers[filter][factor - 1].get() : nullptr;
     
+    // the voices run at the oversampled rate, with the same coefficient updates per second
+    voiceBank.setSampleRate(currentSampleRate * (1 << factor));
+    voiceBank.setControlRate(filterControlRate << factor);
+    
+    if (oversampler != nullptr)
+        oversampler -> reset();
+    
+    // not setLatencySamples: it calls the host and its listeners, which may lock or allocate.
+    // This is the audio thread, timerCallback tells the host
+    oversamplingLatency = oversampler != nullptr ? juce::roundToInt(oversampler -> getLatencyInSamples()) : 0;
+}
+
+void DroneAudioProcessor::timerCallback()
+{
+    int latency = oversamplingLatency;
+    if (latency != getLatencySamples())
+        setLatencySamples(latency);
+}
+
+void DroneAudioProcessor::renderVoices (float* const* voiceOutputs, int numChannels, const juce::MidiBuffer& midi,
+                                        int startSample, int numSamples)
+{
+    if (oversampler == nullptr)
+    {
+        {
+            DRONE_BENCH_STEP(perfMonitor, droneVoiceStep);
+            renderVoiceGroups(voiceOutputs, numSamples);
+        }
+        
+        // MIDI voices are added on top, split at each event in this chunk
+        DRONE_BENCH_STEP(perfMonitor, midiVoiceStep);
+        midiVoices.renderNextBlock(voiceOutputs, numChannels, midi, startSample, numSamples);
+        return;
+    }
+    
+    // The MIDI voices render first, at the base rate, and go up and down through the
+    // oversampler with the drone: the whole output then has the latency the host was told
+    juce::dsp::AudioBlock<float> block(voiceOutputs, (size_t) numDroneVoices, (size_t) numSamples);
+    block.clear();
+    {
+        DRONE_BENCH_STEP(perfMonitor, midiVoiceStep);
+        midiVoices.renderNextBlock(voiceOutputs, numChannels, midi, startSample, numSamples);
+    }
+    
+    // The drone voices are generators: render them at the oversampled rate on top of
+    // the upsampled MIDI voices and filter the sum back down
+    DRONE_BENCH_STEP(perfMonitor, droneVoiceStep);
+    auto oversampledBlock = oversampler -> processSamplesUp(block);
+    int oversampledSamples = (int) oversampledBlock.getNumSamples();
+    renderVoiceGroups(oversampledVoices.getArrayOfWritePointers(), oversampledSamples);
+    
+    for (int voice = 0; voice < numDroneVoices; voice++)
+        juce::FloatVectorOperations::add(oversampledBlock.getChannelPointer((size_t) voice),
+                                         oversampledVoices.getReadPointer(voice), oversampledSamples);
+    
+    oversampler -> processSamplesDown(block);
+}
+
+void DroneAudioProcessor::renderVoiceGroups (float* const* voiceOutputs, int numSamples)
+{
+    // each group of SIMD lanes is an independent set of voices. Up to lanes channels (4 with
+    // SSE, so any stereo layout) are a single group, a single task the audio thread runs itself
+    workerPool.run(voiceBank.getNumGroups(), numSamples, [this, voiceOutputs, numSamples] (int group)
+    {
+        voiceBank.processGroup(group, voiceOutputs, numSamples);
+    });
+}
+
+void DroneAudioProcessor::setFreeRunning()
+{
+    saw.setFrequency(freeSawRate);
+    square.setFrequency(freeSquareRate);
+    LFO.setFrequency(freeDelayRate);
+    
+    // variational delay time: 2000*(1 + LFO), in samples: 0 ~ 4000
+    delayCentre.setTargetValue(freeDelayTime);
+    
+    tempoSynced = false;
+    wasPlaying = false;
+}
+
+void DroneAudioProcessor::syncToHost (int numSamples)
+{
+    // the host's position at the start of this block, once per block
+    juce::Optional<juce::AudioPlayHead::PositionInfo> position;
+    if (tempoSyncParam -> load() >= 0.5f)
+        if (auto* playHead = getPlayHead())
+            position = playHead -> getPosition();
+    
+    juce::Optional<double> bpm = position.hasValue() ? position -> getBpm() : juce::Optional<double>();
+    if (! bpm.hasValue() || *bpm <= 0.0)
+    {
+        // sync off, or a host without a tempo: back to the fixed rates
+        if (tempoSynced)
+            setFreeRunning();
+        return;
+    }
+    
+    // the modulator cycle in quarter notes, the length of a bar from the time signature
+    double barBeats = 4.0;
+    if (auto timeSignature = position -> getTimeSignature())
+        if (timeSignature -> denominator > 0)
+            barBeats = 4.0 * timeSignature -> numerator / timeSignature -> denominator;
+    double cycleBeats = barBeats * (1 << (int) syncCycleParam -> load());
+    
+    double beatsPerSecond = *bpm / 60.0;
+    saw.setFrequency((float) (beatsPerSecond / cycleBeats));
+    LFO.setFrequency((float) (beatsPerSecond / cycleBeats));
+    square.setFrequency((float) (beatsPerSecond / squareCycleBeats));
+    
+    // the centre of the swept delay time, 1/32 ~ 1/4 note. The sweep reaches twice the centre,
+    // scaled by up to maxDelayTimeScale per channel, and has to stay inside the line
+    double noteBeats = 0.125 * (1 << (int) syncDelayParam -> load());
+    float maxCentre = (float) (juce::jmin(currentSampleRate, maxSampleRate) - 2.0) / (2.0f * maxDelayTimeScale);
+    float delayTime = juce::jmin(maxCentre, (float) (noteBeats / beatsPerSecond * currentSampleRate));
+    delayCentre.setTargetValue(delayTime);
+    
+    // Phases from the PPQ position when the transport starts, jumps (a loop, a locate), sync
+    // is switched on or the cycle changes. Otherwise the accumulators run on at the synced rates, there
+    // is nothing to correct per sample
+    bool isPlaying = position -> getIsPlaying();
+    auto ppq = position -> getPpqPosition();
+    if (isPlaying && ppq.hasValue())
+    {
+        bool jumped = ! tempoSynced || ! wasPlaying || cycleBeats != syncedCycleBeats
+                      || std::abs(*ppq - expectedPpq) > 1.0e-3;
+        if (jumped)
+        {
+            auto cyclePhase = [&] (double beats) { double p = *ppq / beats; return (float) (p - std::floor(p)); };
+            saw.setPhase(cyclePhase(cycleBeats));
+            LFO.setPhase(cyclePhase(cycleBeats));
+            square.setPhase(cyclePhase(squareCycleBeats));
+        }
+        expectedPpq = *ppq + numSamples * beatsPerSecond / currentSampleRate;
+        syncedCycleBeats = cycleBeats;
+    }
+    
+    tempoSynced = true;
+    wasPlaying = isPlaying && ppq.hasValue();
+}
+
+void DroneAudioProcessor::updateDelayCentre (int numSamples)
+{
+    // the sweep scales with the centre, so the delay time stays inside the line
+    float centre = delayCentre.skip(numSamples);
+    modMatrix.setOffset(delayTimeDestination, centre);
+    modMatrix.setRouteAmount(delayTimeRoute, centre);
+}
+
+void DroneAudioProcessor::renderModulation (int numSamples)
+{
+    bool exp = true; //exponential control variable for saw LFO control
+    
+    // Every source once per block, skipped when no route reads it
+    if (modMatrix.isSourceUsed(feedbackSaw))
+        saw.process(modMatrix.getSourceBuffer(feedbackSaw), numSamples, exp); // Modulated feedback gain!
+    if (modMatrix.isSourceUsed(delayTimeSaw))
+        LFO.process(modMatrix.getSourceBuffer(delayTimeSaw), numSamples, exp);
+    if (modMatrix.isSourceUsed(balanceSquare))
+        square.process(modMatrix.getSourceBuffer(balanceSquare), numSamples);
+    if (modMatrix.isSourceUsed(modSine))
+        sine.process(modMatrix.getSourceBuffer(modSine), numSamples);
+    
+    // then one multiply-add pass per route into the destinations
+    modMatrix.process(numSamples);
+    
+    // the voices read the cutoff buffer per sample, the drone voices also when oversampled
+    auto* cutoffModulation = modMatrix.hasModulation(cutoffDestination) ? modMatrix.getDestinationBuffer(cutoffDestination) : nullptr;
+    voiceBank.setCutoffModulation(cutoffModulation, oversamplingFactor);
+    midiVoices.setCutoffModulation(cutoffModulation);
+}
+
+void DroneAudioProcessor::updateParameters (int numSamples)
+{
+    frequency.setTargetValue(frequencyParam -> load());
+    lfoRate.setTargetValue(lfoRateParam -> load());
+    lfoDepth.setTargetValue(lfoDepthParam -> load());
+    cutoff.setTargetValue(cutoffParam -> load());
+    resonance.setTargetValue(resonanceParam -> load());
+    
+    // one step of each ramp per block, the voices only see block-rate changes
+    float newFrequency = frequency.skip(numSamples);
+    float newLfoRate = lfoRate.skip(numSamples);
+    float newLfoDepth = lfoDepth.skip(numSamples);
+    float newCutoff = cutoff.skip(numSamples);
+    float newResonance = resonance.skip(numSamples);
+    
+    auto oscType = static_cast<OscType>((int) oscTypeParam -> load());
+    auto lfoType = static_cast<LFOType>((int) lfoTypeParam -> load());
+    auto filterType = static_cast<FilterType>((int) filterTypeParam -> load());
+    float pulseWidth = pulseWidthParam -> load();
+    float pulseWidthMod = pulseWidthModParam -> load();
+    
+    // only the selected source's route into the cutoff carries the amount
+    sine.setFrequency(modSineRateParam -> load());
+    int cutoffModSource = (int) cutoffModSourceParam -> load();
+    for (int source = 0; source < numModSources; source++)
+        modMatrix.setRouteAmount(cutoffRoutes[source], source == cutoffModSource ? cutoffModAmountParam -> load() : 0.0f);
+    
+    // the voices apply their own LFO's routes, the depth parameter's and the selected one's
+    modMatrix.setRouteAmount(voiceLFORoute, newLfoDepth);
+    float voiceLFODepth = modMatrix.getVoiceAmount(voiceLFO, cutoffDestination);
+    
+    for (int voice = 0; voice < numDroneVoices; voice++)
+    {
+        voiceBank.setOSCType(voice, oscType);
+        voiceBank.setPulseWidth(voice, pulseWidth, pulseWidthMod);
+        voiceBank.setOSCFrequency(voice, newFrequency);
+        voiceBank.setLFOType(voice, lfoType);
+        voiceBank.setLFORate(voice, newLfoRate);
+        voiceBank.setLFODepth(voice, voiceLFODepth);
+        voiceBank.setFilterType(voice, filterType);
+        voiceBank.setCutoff(voice, newCutoff);
+        voiceBank.setResonance(voice, newResonance);
+    }
+    
+    // MIDI voices pick these up at their next note-on
+    midiVoices.setVoiceParameters(oscType, lfoType, newLfoRate, voiceLFODepth, filterType, newCutoff, newResonance);
+    midiVoices.setPulseWidth(pulseWidth, pulseWidthMod);
+    
+    auto delayInterpolation = static_cast<DelayInterpolation>((int) delayInterpolationParam -> load());
+    for (int channel = 0; channel < numDroneVoices; channel++)
+        delays[channel].setInterpolation(delayInterpolation);
+    
+    outputStage.setPanLaw(static_cast<PanLaw>((int) panLawParam -> load()));
+    
+    reverb.setMix(reverbMixParam -> load());
+    reverb.setDecayTime(reverbDecayParam -> load());
+    reverb.setDamping(reverbDampingParam -> load());
+    
+    // the stacks recompute their detuning and panning, only when a setting moves
+    int newUnisonVoices = (int) unisonVoicesParam -> load();
+    float newUnisonDetune = unisonDetuneParam -> load();
+    float newUnisonWidth = unisonWidthParam -> load();
+    if (newUnisonVoices != unisonVoices || newUnisonDetune != unisonDetune || newUnisonWidth != unisonWidth)
+        setUnison(newUnisonVoices, newUnisonDetune, newUnisonWidth);
+    
+    int newWaveshapes = (int) waveshapesParam -> load();
+    if (newWaveshapes != waveshapes)
+        setWaveshapes(newWaveshapes);
+    
+    int newOversamplingFactor = (int) oversamplingParam -> load();
+    int newOversamplingFilter = (int) oversamplingFilterParam -> load();
+    if (newOversamplingFactor != oversamplingFactor || newOversamplingFilter != oversamplingFilter)
+        setOversampling(newOversamplingFactor, newOversamplingFilter);
 }
 
 void DroneAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages)
 {
-    int numChannels = buffer.getNumChannels();
-    if (numChannels < 2) return; // Avoid accessing nonexistent channels
+    juce::ScopedNoDenormals noDenormals;
+    DRONE_REALTIME_SCOPE; // debug builds assert on any allocation from here on
+    
+    // a new configuration from prepareToPlay, set up before anything runs
+    EngineConfig config;
+    if (configSwap.fetch(config))
+        applyConfig(config);
+    
+    DRONE_PERF_BLOCK(perfMonitor, buffer.getNumSamples()); // whole block, against its deadline
+    
+    // one voice and delay line per channel, as prepared
+    int numChannels = juce::jmin(buffer.getNumChannels(), numDroneVoices);
+    for (int channel = numChannels; channel < buffer.getNumChannels(); channel++)
+        buffer.clear(channel, 0, buffer.getNumSamples());
     
     int numSamples = buffer.getNumSamples();
-    auto* left = buffer.getWritePointer(0);
-    auto* right = buffer.getWritePointer(1);
+    updateParameters(numSamples);
+    syncToHost(numSamples);
+    updateDelayCentre(numSamples);
+    
+    auto* const* outputs = buffer.getArrayOfWritePointers();
+    
+    // delay the output instead of the input as in a feedback comb filter
+    // y[n] = x[n] + g*y[n - M], e.g..
+    bool feedback = true; // true: feedback delay; false: feedforward delay
+    
+    auto* const* synth = scratch.getArrayOfWritePointers() + numModulatorChannels; // one per channel
+    auto* const* channelDelayTimes = synth + numDroneVoices; // one per channel
+    auto* feedbackGains = modMatrix.getDestinationBuffer(feedbackDestination);
+    auto* delayTimes = modMatrix.getDestinationBuffer(delayTimeDestination);
+    auto* balances = modMatrix.getDestinationBuffer(balanceDestination);
+    auto* panGains = scratch.getWritePointer(panGainChannel);
+    int blockSize = chunkSize;
  
-    // DSP loop
-    for (int i = 0; i < numSamples; i++) {
-
-        bool exp = true; //exponential control variable for saw LFO control
+    // Render in chunks of at most the prepared block size
+    for (int start = 0; start < numSamples; start += blockSize) {
         
-        float sampleL = filterSynthL.process(!exp); // Left: linear saw cutoff LFO
-        float sampleR = filterSynthR.process(exp); // Right: exponential ramping LFO
-    
-        // set delay feedback gain
-        float feedbackGain = saw.process(exp);  // Modulated feedback gain!
-        delayL.setFeedbackGain(feedbackGain);
-        delayR.setFeedbackGain(feedbackGain);
+        int n = juce::jmin(blockSize, numSamples - start);
+        
+        {
+            // the modulators count towards the delay stage, as they did before the matrix
+            DRONE_PERF_STAGE(perfMonitor, delayStage);
+            DRONE_BENCH_STEP(perfMonitor, modulatorStep);
+            renderModulation(n);
+        }
+        
+        {
+            DRONE_PERF_STAGE(perfMonitor, synthStage);
+            
+            // Generate every channel's drone voice in one pass and the MIDI voices, oversampled if selected
+            renderVoices(synth, numChannels, midiMessages, start, n);
+        }
         
-       // set variational delay time
-        float delayTime = 2000 *(1 + LFO.process(exp)); // delay time in samples: 0 ~ 4000
-        delayL.setDelaySamples(delayTime);
-        delayR.setDelaySamples(delayTime);
-    
-        // delay the output instead of the input as in a feedback comb filter
-        // y[n] = x[n] + g*y[n - M], e.g..
-        bool feedback = true; // true: feedback delay; false: feedforward delay
+        {
+            DRONE_PERF_STAGE(perfMonitor, delayStage);
+            DRONE_BENCH_STEP(perfMonitor, delayLineStep);
+            
+            // the matrix modulates the feedback gain and the delay time, both come in as buffers.
+            // Every channel's delay line is independent, so they can run in parallel
+            workerPool.run(numChannels, n, [&] (int channel)
+            {
+                juce::FloatVectorOperations::multiply(channelDelayTimes[channel], delayTimes, delayTimeScales[channel], n);
+                delays[channel].process(synth[channel], synth[channel], n, channelDelayTimes[channel], feedbackGains, feedback);
+            });
+        }
         
-        // Dynamic stereo mixing with a 0.5 output gain applied
-        float balance = square.process()*0.5 + 0.5; // 0 ~ 1
-        left[i] = 0.5*balance*delayL.process(sampleL, feedback);
-        right[i] = 0.5*(1 - balance) * delayR.process(sampleR, feedback);
+        float* chunkOutputs[maxChannels];
+        for (int channel = 0; channel < numChannels; channel++)
+            chunkOutputs[channel] = outputs[channel] + start;
         
+        {
+            // Dynamic panning over the channels with a 0.5 output gain applied
+            DRONE_PERF_STAGE(perfMonitor, outputStage);
+            DRONE_BENCH_STEP(perfMonitor, outputMixStep);
+            outputStage.mixPanned(chunkOutputs, synth, numChannels, balances, panGains, n);
+        }
+        
+        {
+            // runs at mix 0 too: the reverb skips itself once the mix has ramped out
+            DRONE_PERF_STAGE(perfMonitor, delayStage);
+            DRONE_BENCH_STEP(perfMonitor, reverbStep);
+            reverb.process(chunkOutputs[0], numChannels > 1 ? chunkOutputs[1] : nullptr, n);
+        }
     }
+    
+    {
+        // Protect the output: DC blocker and limiter over the whole buffer
+        DRONE_PERF_STAGE(perfMonitor, outputStage);
+        DRONE_BENCH_STEP(perfMonitor, limiterStep);
+        outputStage.process(buffer);
+    }
+    
+    coeffUpdatesPerSecond = voiceBank.getCoeffUpdatesPerSecond();
 
 }
 
@@ -173,10 +779,17 @@ void DroneAudioProcessor::changeProgramName (int index, const juce::String& newN
 //==============================================================================
 
 
+void DroneAudioProcessor::audioWorkgroupContextChanged (const juce::AudioWorkgroup& workgroup)
+{
+    // the workers share the deadline of the host's audio thread
+    workerPool.setWorkgroup(workgroup);
+}
+
 void DroneAudioProcessor::releaseResources()
 {
     // When playback stops, you can use this as an opportunity to free up any
     // spare memory, etc.
+    workerPool.setNumWorkers(0); // no threads left spinning while stopped
 }
 
 #ifndef JucePlugin_PreferredChannelConfigurations
@@ -186,12 +799,10 @@ bool DroneAudioProcessor::isBusesLayoutSupported (const BusesLayout& layouts) co
     juce::ignoreUnused (layouts);
     return true;
   #else
-    // This is the place where you check if the layout is supported.
-    // In this template code we only support mono or stereo.
-    // Some plugin hosts, such as certain GarageBand versions, will only
-    // load plugins that support stereo bus layouts.
-    if (layouts.getMainOutputChannelSet() != juce::AudioChannelSet::mono()
-     && layouts.getMainOutputChannelSet() != juce::AudioChannelSet::stereo())
+    // Any layout from mono up to one channel per voice of the bank,
+    // the channels are treated as a ring of speakers
+    int numOutputChannels = layouts.getMainOutputChannelSet().size();
+    if (numOutputChannels < 1 || numOutputChannels > maxChannels)
         return false;
 
     // This checks if the input layout matches the output layout
@@ -220,15 +831,19 @@ juce::AudioProcessorEditor* DroneAudioProcessor::createEditor()
 //==============================================================================
 void DroneAudioProcessor::getStateInformation (juce::MemoryBlock& destData)
 {
-    // You should use this method to store your parameters in the memory block.
-    // You could do that either as raw data, or use the XML or ValueTree classes
-    // as intermediaries to make it easy to save and load complex data.
+    // Store the parameters as XML
+    auto state = apvts.copyState();
+    std::unique_ptr<juce::XmlElement> xml (state.createXml());
+    copyXmlToBinary (*xml, destData);
 }
 
 void DroneAudioProcessor::setStateInformation (const void* data, int sizeInBytes)
 {
-    // You should use this method to restore your parameters from this memory block,
-    // whose contents will have been created by the getStateInformation() call.
+    // Restore the parameters written by getStateInformation()
+    std::unique_ptr<juce::XmlElement> xml (getXmlFromBinary (data, sizeInBytes));
+    
+    if (xml != nullptr && xml -> hasTagName (apvts.state.getType()))
+        apvts.replaceState (juce::ValueTree::fromXml (*xml));
 }
 
 //==============================================================================
@@ -12,11 +12,22 @@
 #include <juce_dsp/juce_dsp.h>
 #include "Oscillator.h"
 #include "FilterSynth.h"
+#include "FilterSynthBank.h"
+#include "VoiceAllocator.h"
 #include "Delay.h"
+#include "FDNReverb.h"
+#include "PerformanceMonitor.h"
+#include "OutputStage.h"
+#include "WorkerPool.h"
+#include "MemoryArena.h"
+#include "RealtimeSwap.h"
+#include "AllocationTracker.h"
+#include "ModulationMatrix.h"
 //==============================================================================
 /**
 */
-class DroneAudioProcessor  : public juce::AudioProcessor
+class DroneAudioProcessor  : public juce::AudioProcessor,
+                             private juce::Timer
 {
 public:
     //==============================================================================
@@ -26,6 +37,7 @@ public:
     //==============================================================================
     void prepareToPlay (double sampleRate, int samplesPerBlock) override;
     void releaseResources() override;
+    void audioWorkgroupContextChanged (const juce::AudioWorkgroup& workgroup) override;
 
    #ifndef JucePlugin_PreferredChannelConfigurations
     bool isBusesLayoutSupported (const BusesLayout& layouts) const override;
@@ -55,25 +67,165 @@ public:
     //==============================================================================
     void getStateInformation (juce::MemoryBlock& destData) override;
     void setStateInformation (const void* data, int sizeInBytes) override;
+    
+    //==============================================================================
+    // Filter coefficient updates per second across both voices, measured each block
+    float getCoeffUpdatesPerSecond() const { return coeffUpdatesPerSecond.load(); }
+    
+    // Block and stage timings of processBlock, read from the editor's timer
+    PerformanceMonitor& getPerformanceMonitor() { return perfMonitor; }
+    
+    // Host parameters and the saved state
+    static juce::AudioProcessorValueTreeState::ParameterLayout createParameterLayout();
+    juce::AudioProcessorValueTreeState apvts;
 
 private:
     //==============================================================================
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (DroneAudioProcessor)
-    FilterSynth filterSynthL; //instantiate a filterSynth object with default initialization
-    FilterSynth filterSynthR;
+    FilterSynthBank voiceBank; // one drone voice per output channel, processed side by side in SIMD lanes
+    static constexpr int maxChannels = FilterSynthBank::maxVoices;
+    int numDroneVoices = 2; // output channels, set by applyConfig
+    VoiceAllocator midiVoices; // voices played from MIDI on top of the drone
     sawOSC saw;
     squareOSC square;
     sawOSC LFO;
     sineOSC sine;
-    juce::dsp::Limiter<float> limiter;
+    OutputStage outputStage; // balance mix, DC blocker and limiter
+    
+    // Raw parameter values, written by the host and read lock-free on the audio thread
+    std::atomic<float>* frequencyParam = nullptr;
+    std::atomic<float>* oscTypeParam = nullptr;
+    std::atomic<float>* pulseWidthParam = nullptr;
+    std::atomic<float>* pulseWidthModParam = nullptr;
+    std::atomic<float>* waveshapesParam = nullptr;
+    std::atomic<float>* unisonVoicesParam = nullptr;
+    std::atomic<float>* unisonDetuneParam = nullptr;
+    std::atomic<float>* unisonWidthParam = nullptr;
+    std::atomic<float>* lfoTypeParam = nullptr;
+    std::atomic<float>* lfoRateParam = nullptr;
+    std::atomic<float>* lfoDepthParam = nullptr;
+    std::atomic<float>* filterTypeParam = nullptr;
+    std::atomic<float>* cutoffParam = nullptr;
+    std::atomic<float>* resonanceParam = nullptr;
+    std::atomic<float>* delayInterpolationParam = nullptr;
+    std::atomic<float>* panLawParam = nullptr;
+    std::atomic<float>* workerThreadsParam = nullptr;
+    std::atomic<float>* oversamplingParam = nullptr;
+    std::atomic<float>* oversamplingFilterParam = nullptr;
+    std::atomic<float>* modSineRateParam = nullptr;
+    std::atomic<float>* cutoffModSourceParam = nullptr;
+    std::atomic<float>* cutoffModAmountParam = nullptr;
+    std::atomic<float>* reverbMixParam = nullptr;
+    std::atomic<float>* reverbDecayParam = nullptr;
+    std::atomic<float>* reverbDampingParam = nullptr;
+    std::atomic<float>* tempoSyncParam = nullptr;
+    std::atomic<float>* syncCycleParam = nullptr;
+    std::atomic<float>* syncDelayParam = nullptr;
+    
+    // Smoothed values, advanced once per block
+    juce::SmoothedValue<float, juce::ValueSmoothingTypes::Multiplicative> frequency; // oscillator frequency
+    juce::SmoothedValue<float, juce::ValueSmoothingTypes::Multiplicative> lfoRate; // LFO rate
+    juce::SmoothedValue<float> lfoDepth; // LFO depth, modulating the cutoff freuqnecy in Hz
+    juce::SmoothedValue<float, juce::ValueSmoothingTypes::Multiplicative> cutoff;
+    juce::SmoothedValue<float> resonance;
+    juce::SmoothedValue<float, juce::ValueSmoothingTypes::Multiplicative> delayCentre; // samples, glides to a new synced note length
+    
+    void updateParameters(int numSamples); // apply the parameters to the voices, once per block
+    
+    int filterControlRate = 32; // samples between filter coefficient updates
+    
+    // Baked oscillator waveshapes, built by the first prepareToPlay
+    WavetableSet wavetables;
+    bool wavetablesBuilt = false;
+    WavetableQuality wavetableQuality = WavetableQuality::Medium;
+    bool fixedPointModulators = true; // the 0.01 Hz modulators stall in a float phase over long runs
+    
+    // The waveshapes parameter: the tables, or computed in one MathAccuracy tier
+    int waveshapes = 0;
+    bool useWavetables = true;
+    MathAccuracy mathAccuracy = MathAccuracy::Exact; // waveshapes computed without the tables
+    void setWaveshapes(int choice); // real-time safe, from applyConfig and updateParameters
+    
+    // Unison as last applied: detuned saws stacked per voice, 1 = the selected oscillator
+    int unisonVoices = 1;
+    float unisonDetune = 25.0f; // cents, outermost voice from the note
+    float unisonWidth = 1.0f;
+    void setUnison(int numVoices, float detuneCents, float width); // the drone and the MIDI voices, real-time safe
+    std::atomic<float> coeffUpdatesPerSecond { 0.0f };
+    
+    // Oversampling of the voices: factor 0 (off) to 3 (8x). The drone voices render at the
+    // oversampled rate, the MIDI voices at the base rate pass through the same filters
+    enum OversamplingFilter { polyphaseIIR, linearPhaseFIR, numOversamplingFilters };
+    static constexpr int numOversamplingFactors = 4;
+    std::unique_ptr<juce::dsp::Oversampling<float>> oversamplers[numOversamplingFilters][numOversamplingFactors - 1];
+    juce::dsp::Oversampling<float>* oversampler = nullptr; // the selected one, nullptr when off
+    int oversamplingFactor = 0;
+    int oversamplingFilter = polyphaseIIR;
+    int oversamplingChannels = 0;
+    double currentSampleRate = 44100.0;
+    
+    juce::AudioBuffer<float> oversampledVoices; // the voice bank's output at the oversampled rate, sized in prepareToPlay
+    
+    // The latency of the selected oversampler. setOversampling runs on the audio thread, so
+    // the host only hears of a change from the message thread, in timerCallback
+    std::atomic<int> oversamplingLatency { 0 };
+    void timerCallback() override;
+    
+    void setOversampling(int factor, int filter);
+    void renderVoices(float* const* voiceOutputs, int numChannels, const juce::MidiBuffer& midi, int startSample, int numSamples);
+    void renderVoiceGroups(float* const* voiceOutputs, int numSamples); // the voice bank, one task per SIMD group
+    
+    WorkerPool workerPool; // optional, renders independent channels in parallel on real-time threads
+    
+    PerformanceMonitor perfMonitor;
+    
+    // Configuration published by prepareToPlay, applied without allocating at the top of processBlock
+    RealtimeSwap<EngineConfig> configSwap;
+    void applyConfig(const EngineConfig& config);
+    
+    // One delay line per channel, decorrelated by scaling the swept delay time.
+    // Their memory comes from the arena, reserved for the highest supported sample rate
+    static constexpr double maxSampleRate = 192000.0;
+    static constexpr int maxDelaySamples = (int) maxSampleRate; // one second
+    MemoryArena delayArena;
+    Delay delays[maxChannels];
+    float delayTimeScales[maxChannels] = {};
+    static constexpr float maxDelayTimeScale = 1.1f; // the longest, the swept time must still fit the line
+    
+    // Stereo reverb on the first two output channels, its lines in the same arena
+    FDNReverb reverb;
     
-    float frequency = 800; // oscillator frequency
+    // Modulation routing: the modulator oscillators are the sources, rendered once per
+    // block when a route reads them, each destination is a per-sample buffer. The voices'
+    // own LFOs are a per-voice source, their routes are applied inside the voices
+    enum ModSource { feedbackSaw, delayTimeSaw, balanceSquare, modSine, voiceLFO, numModSources };
+    enum ModDestination { feedbackDestination, delayTimeDestination, balanceDestination, cutoffDestination, numModDestinations };
+    ModulationMatrix modMatrix;
+    int cutoffRoutes[numModSources] = {}; // one route per source into the cutoff, the selected one gets the amount
+    int delayTimeRoute = -1;
+    int voiceLFORoute = -1; // its amount is the LFO depth
+    void setUpModulation(); // the routes, in the constructor
+    void renderModulation(int numSamples);
     
-    float lfoRate = 1; // LFO rate
-    float lfoDepth = 100; // LFO depth, modulating the cutoff freuqnecy in Hz
+    // Host tempo sync: the modulator rates and the delay time follow the tempo, read once per
+    // block. The phases come from the PPQ position when the transport starts or jumps, in
+    // between the fixed-point accumulators carry them, so every instance stays locked
+    static constexpr float freeSawRate = 0.01f, freeSquareRate = 1.0f, freeDelayRate = 0.01f; // Hz, unsynced
+    static constexpr float freeDelayTime = 2000.0f; // samples, the centre of the swept delay time
+    static constexpr double squareCycleBeats = 2.0; // a half note, 1 Hz at 120 bpm
+    bool tempoSynced = false;
+    bool wasPlaying = false;
+    double expectedPpq = 0.0; // where the last block said this one starts
+    double syncedCycleBeats = 0.0; // a new cycle length also takes the phases from the position
+    void syncToHost(int numSamples);
+    void setFreeRunning();
+    void updateDelayCentre(int numSamples); // the matrix follows the ramp, once per block
     
-    Delay delayL;
-    Delay delayR;
+    // Per-block scratch buffers, sized in prepareToPlay: the pan gains, then one synth
+    // channel and one delay time channel per voice
+    enum ScratchChannel { panGainChannel, numModulatorChannels };
+    juce::AudioBuffer<float> scratch;
+    int chunkSize = 1; // processBlock renders in chunks of at most this many samples
     
     
 };
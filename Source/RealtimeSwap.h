@@ -0,0 +1,60 @@
+/*
+  ==============================================================================
+
+    RealtimeSwap.h
+    Lock-free hand-over of a value from one writer thread to the audio thread,
+    used to apply a new engine configuration at the top of processBlock.
+    Created: 17 Oct 2026 10:02:51pm
+    Author:  chenzuyu
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <JuceHeader.h>
+#include <atomic>
+
+// What the processing is sized for, prepared by prepareToPlay
+struct EngineConfig
+{
+    double sampleRate = 44100.0;
+    int maxBlockSize = 512;
+    int numChannels = 2;
+};
+
+// Triple buffer: the writer fills its own slot and swaps it with the middle one,
+// the reader swaps the middle one with its own when it is newer. Neither side
+// waits or allocates, and the reader always gets the latest complete value
+template <typename T>
+class RealtimeSwap
+{
+public:
+    // Writer thread
+    void publish(const T& value)
+    {
+        slots[writeSlot] = value;
+        int previous = middle.exchange(writeSlot | newValueBit, std::memory_order_acq_rel);
+        writeSlot = previous & slotMask;
+    }
+
+    // Reader thread: true, and the value, if one was published since the last fetch
+    bool fetch(T& value)
+    {
+        if ((middle.load(std::memory_order_relaxed) & newValueBit) == 0)
+            return false;
+
+        int previous = middle.exchange(readSlot, std::memory_order_acq_rel);
+        readSlot = previous & slotMask;
+        value = slots[readSlot];
+        return true;
+    }
+
+private:
+    static constexpr int slotMask = 3;
+    static constexpr int newValueBit = 4;
+
+    T slots[3] {};
+    std::atomic<int> middle { 1 }; // slot index | newValueBit
+    int writeSlot = 0; // writer only
+    int readSlot = 2;  // reader only
+};
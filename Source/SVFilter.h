@@ -0,0 +1,147 @@
+/*
+  ==============================================================================
+
+    SVFilter.h
+    Topology-preserving (TPT) state-variable filter, cheap to modulate per
+    sample: the only cutoff-dependent term is tan(pi*fc/fs), read from a table.
+    Created: 17 Oct 2026 9:14:26pm
+    Author:  chenzuyu
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <JuceHeader.h>
+
+// tan(pi * fc/fs), the prewarped integrator gain of the TPT filters
+class TanLookup
+{
+public:
+    static constexpr int tableSize = 2048;
+    static constexpr float maxNormalisedCutoff = 0.49f; // tan grows without bound at Nyquist
+
+    TanLookup()
+    {
+        for (int i = 0; i <= tableSize; i++)
+            table[i] = (float) std::tan(juce::MathConstants<double>::pi * maxNormalisedCutoff * i / tableSize);
+        table[tableSize + 1] = table[tableSize]; // guard sample for the interpolation
+    }
+
+    // the one shared table, build it from prepareToPlay rather than the audio thread
+    static const TanLookup& get()
+    {
+        static const TanLookup lookup;
+        return lookup;
+    }
+
+    // fc/fs, clamped to 0 ~ maxNormalisedCutoff, linear interpolation
+    float operator()(float normalisedCutoff) const
+    {
+        float pos = juce::jlimit(0.0f, (float) tableSize, normalisedCutoff * (tableSize / maxNormalisedCutoff));
+        int index = (int) pos;
+        float frac = pos - index;
+
+        return table[index] + frac * (table[index + 1] - table[index]);
+    }
+
+private:
+    float table[tableSize + 2];
+};
+
+// Which response process() returns, processAll() gives all of them
+enum class SVFOutput
+{
+    LowPass,
+    BandPass,
+    HighPass,
+    Notch
+};
+
+struct SVFOutputs
+{
+    float lowPass, bandPass, highPass, notch;
+};
+
+class SVFilter
+{
+public:
+    // The selected response is a mix of the input and the two states:
+    // y = m0*x + m1*bandPass + m2*lowPass, so it can change per lane or per voice
+    static void getOutputMix(SVFOutput output, float k, float& m0, float& m1, float& m2)
+    {
+        switch (output)
+        {
+            case SVFOutput::LowPass:  m0 = 0.0f; m1 = 0.0f; m2 = 1.0f;  return;
+            case SVFOutput::BandPass: m0 = 0.0f; m1 = 1.0f; m2 = 0.0f;  return;
+            case SVFOutput::HighPass: m0 = 1.0f; m1 = -k;   m2 = -1.0f; return;
+            case SVFOutput::Notch:    m0 = 1.0f; m1 = -k;   m2 = 0.0f;  return;
+        }
+        m0 = 0.0f; m1 = 0.0f; m2 = 1.0f;
+    }
+
+    // Damping k = 1/Q. The TPT structure stays stable for any k > 0 and any cutoff,
+    // even when both move every sample
+    static float getDamping(float resonance)
+    {
+        return 1.0f / juce::jmax(0.1f, resonance);
+    }
+
+    void setResonance(float resonance)
+    {
+        k = getDamping(resonance);
+        getOutputMix(output, k, m0, m1, m2);
+    }
+
+    void setOutput(SVFOutput newOutput)
+    {
+        output = newOutput;
+        getOutputMix(output, k, m0, m1, m2);
+    }
+
+    void reset()
+    {
+        ic1eq = ic2eq = 0.0f;
+    }
+
+    // one sample of the selected response, g = TanLookup::get()(fc/fs)
+    float process(float input, float g)
+    {
+        float bandPass, lowPass;
+        tick(input, g, bandPass, lowPass);
+
+        return m0 * input + m1 * bandPass + m2 * lowPass;
+    }
+
+    // one sample of every response at once
+    SVFOutputs processAll(float input, float g)
+    {
+        float bandPass, lowPass;
+        tick(input, g, bandPass, lowPass);
+
+        float highPass = input - k * bandPass - lowPass;
+        return { lowPass, bandPass, highPass, lowPass + highPass };
+    }
+
+private:
+    // trapezoidal integrators solved without a unit delay in the loop
+    void tick(float input, float g, float& v1, float& v2)
+    {
+        float a1 = 1.0f / (1.0f + g * (g + k));
+        float a2 = g * a1;
+        float a3 = g * a2;
+
+        float v3 = input - ic2eq;
+        v1 = a1 * ic1eq + a2 * v3;
+        v2 = ic2eq + a2 * ic1eq + a3 * v3;
+
+        ic1eq = 2.0f * v1 - ic1eq;
+        ic2eq = 2.0f * v2 - ic2eq;
+        JUCE_SNAP_TO_ZERO(ic1eq);
+        JUCE_SNAP_TO_ZERO(ic2eq);
+    }
+
+    SVFOutput output = SVFOutput::LowPass;
+    float k = 1.0f / 0.7f;
+    float m0 = 0.0f, m1 = 0.0f, m2 = 1.0f;
+    float ic1eq = 0.0f, ic2eq = 0.0f; // integrator states
+};
@@ -0,0 +1,166 @@
+/*
+  ==============================================================================
+
+    UnisonOscillator.cpp
+    A stack of detuned PolyBLEP saws (a supersaw) spread across the stereo
+    field. The phases of all voices sit in contiguous SIMD registers and
+    advance together, so 16 voices cost a few times one.
+    Created: 18 Oct 2026 12:06:37am
+    Author:  chenzuyu
+
+  ==============================================================================
+*/
+
+#include "UnisonOscillator.h"
+
+UnisonOscillator::UnisonOscillator()
+{
+    for (int g = 0; g < maxGroups; g++)
+    {
+        phase[g] = Vec::expand(0.0f);
+        delta[g] = Vec::expand(0.0f);
+        inverseDelta[g] = Vec::expand(0.0f);
+        gainLeft[g] = Vec::expand(0.0f);
+        gainRight[g] = Vec::expand(0.0f);
+        gainMono[g] = Vec::expand(0.0f);
+    }
+
+    reset(0.0f);
+    updateVoices();
+}
+
+void UnisonOscillator::setSampleRate(float sr)
+{
+    sampleRate = sr;
+    updateVoices();
+}
+
+void UnisonOscillator::setFrequency(float f)
+{
+    frequency = f;
+    updateVoices();
+}
+
+void UnisonOscillator::setNumVoices(int n)
+{
+    numVoices = juce::jlimit(1, maxVoices, n);
+    numGroups = (numVoices + lanes - 1) / lanes;
+    updateVoices();
+}
+
+void UnisonOscillator::setDetune(float cents)
+{
+    detune = cents;
+    updateVoices();
+}
+
+void UnisonOscillator::setStereoWidth(float width)
+{
+    stereoWidth = juce::jlimit(0.0f, 1.0f, width);
+    updateVoices();
+}
+
+void UnisonOscillator::reset(float startPhase)
+{
+    // golden-ratio steps spread the voices evenly over the cycle, the same way every time
+    for (int v = 0; v < maxVoices; v++)
+    {
+        float p = startPhase + 0.618034f * v;
+        phase[v / lanes].set((size_t) (v % lanes), p - std::floor(p));
+    }
+}
+
+void UnisonOscillator::updateVoices()
+{
+    // constant power: uncorrelated voices add up in power, not in amplitude
+    float normalise = 1.0f / std::sqrt((float) numVoices);
+
+    for (int v = 0; v < maxVoices; v++)
+    {
+        auto& d = delta[v / lanes];
+        auto lane = (size_t) (v % lanes);
+
+        if (v >= numVoices)
+        {
+            d.set(lane, 0.0f);
+            inverseDelta[v / lanes].set(lane, 0.0f);
+            gainLeft[v / lanes].set(lane, 0.0f);
+            gainRight[v / lanes].set(lane, 0.0f);
+            gainMono[v / lanes].set(lane, 0.0f);
+            continue;
+        }
+
+        // -1 ~ 1 across the stack, the detune and the pan position both follow it
+        float position = numVoices > 1 ? 2.0f * v / (numVoices - 1) - 1.0f : 0.0f;
+        float voiceDelta = frequency * std::pow(2.0f, detune * position / 1200.0f) / sampleRate;
+        d.set(lane, voiceDelta);
+        inverseDelta[v / lanes].set(lane, voiceDelta > 0.0f ? 1.0f / voiceDelta : 0.0f);
+
+        // constant power pan
+        float angle = (stereoWidth * position + 1.0f) * juce::MathConstants<float>::pi * 0.25f;
+        gainLeft[v / lanes].set(lane, normalise * std::cos(angle));
+        gainRight[v / lanes].set(lane, normalise * std::sin(angle));
+        gainMono[v / lanes].set(lane, normalise);
+    }
+}
+
+void UnisonOscillator::process(float* left, float* right, int numSamples)
+{
+    render<true>(left, right, numSamples, nullptr);
+}
+
+void UnisonOscillator::process(float* dest, int numSamples)
+{
+    render<false>(dest, nullptr, numSamples, gainMono);
+}
+
+void UnisonOscillator::processSide(float* dest, int numSamples, bool rightSide)
+{
+    render<false>(dest, nullptr, numSamples, rightSide ? gainRight : gainLeft);
+}
+
+template <bool stereo>
+void UnisonOscillator::render(float* left, float* right, int numSamples, const Vec* gains)
+{
+    const auto one = Vec::expand(1.0f);
+    const auto zero = Vec::expand(0.0f);
+
+    for (int i = 0; i < numSamples; i++)
+    {
+        auto sumLeft = zero;
+        auto sumRight = zero;
+
+        for (int g = 0; g < numGroups; g++)
+        {
+            auto p = phase[g];
+            const auto d = delta[g];
+
+            // PolyBLEP saw as in blepSawOSC::shape, the two residual branches become lane masks
+            auto t = p * inverseDelta[g];
+            auto rising = t + t - t * t - one;                        // p < d
+            auto u = (p - one) * inverseDelta[g];
+            auto falling = u * u + u + u + one;                       // p > 1 - d
+            auto blep = (rising & Vec::lessThan(p, d)) + (falling & Vec::greaterThan(p, one - d));
+            auto saw = p * 2.0f - one - blep;
+
+            if constexpr (stereo)
+            {
+                sumLeft += saw * gainLeft[g];
+                sumRight += saw * gainRight[g];
+            }
+            else
+            {
+                sumLeft += saw * gains[g];
+            }
+
+            // phase wrapping without branches
+            p += d;
+            p -= one & Vec::greaterThan(p, one);
+            phase[g] = p;
+        }
+
+        left[i] = sumLeft.sum();
+        if constexpr (stereo)
+            right[i] = sumRight.sum();
+    }
+}
@@ -0,0 +1,58 @@
+/*
+  ==============================================================================
+
+    UnisonOscillator.h
+    A stack of detuned PolyBLEP saws (a supersaw) spread across the stereo
+    field. The phases of all voices sit in contiguous SIMD registers and
+    advance together, so 16 voices cost a few times one.
+    Created: 18 Oct 2026 12:06:37am
+    Author:  chenzuyu
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <JuceHeader.h>
+
+class UnisonOscillator
+{
+public:
+    using Vec = juce::dsp::SIMDRegister<float>;
+
+    static constexpr int lanes = (int) Vec::SIMDNumElements;
+    static constexpr int maxVoices = 16;
+    static constexpr int maxGroups = maxVoices / lanes;
+
+    UnisonOscillator();
+
+    void setSampleRate(float sr);
+    void setFrequency(float f); // centre frequency, the voices spread around it
+    void setNumVoices(int n); // 1 ~ maxVoices
+    void setDetune(float cents); // the outermost voices sit +-cents from the centre
+    void setStereoWidth(float width); // 0 all voices centred ~ 1 spread from hard left to hard right
+    void reset(float phase); // restart the voices, their phases spread from phase so they do not start in step
+    int getNumVoices() const { return numVoices; }
+
+    // Sum of all voices, at constant power as the voice count changes
+    void process(float* left, float* right, int numSamples);
+    void process(float* dest, int numSamples); // mono, the sum before panning
+    void processSide(float* dest, int numSamples, bool rightSide); // one channel of the stereo process, at the cost of mono
+
+private:
+    void updateVoices(); // increments and pan gains, at control rate only
+    template <bool stereo>
+    void render(float* left, float* right, int numSamples, const Vec* gains); // gains of the one channel when not stereo
+
+    float sampleRate = 48000.0f;
+    float frequency = 110.0f;
+    int numVoices = 1;
+    int numGroups = 1;
+    float detune = 0.0f;
+    float stereoWidth = 1.0f;
+
+    // One lane per voice, the unused lanes have zero gain
+    Vec phase[maxGroups];
+    Vec delta[maxGroups];
+    Vec inverseDelta[maxGroups]; // 1/delta, scales the PolyBLEP residual
+    Vec gainLeft[maxGroups], gainRight[maxGroups], gainMono[maxGroups];
+};
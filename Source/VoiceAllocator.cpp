@@ -0,0 +1,315 @@
+/*
+  ==============================================================================
+
+    VoiceAllocator.cpp
+    Preallocated pool of FilterSynth voices played from MIDI, with voice
+    stealing and sample-accurate event handling.
+    Created: 17 Oct 2026 6:48:03pm
+    Author:  chenzuyu
+
+  ==============================================================================
+*/
+
+#include "VoiceAllocator.h"
+
+VoiceAllocator::VoiceAllocator()
+{
+    // slow attack and long release, suited to drones
+    setEnvelope({ 0.5f, 0.0f, 1.0f, 2.0f });
+}
+
+void VoiceAllocator::prepare(float sampleRate)
+{
+    // long enough not to click, short enough not to smear the new note's attack
+    stealFadeLength = juce::jmax(1, juce::roundToInt(sampleRate * 0.005f));
+
+    for (auto& voice : voices)
+    {
+        voice.synth.setSampleRate(sampleRate);
+        voice.synth.setControlRate(32);
+        voice.envelope.setSampleRate(sampleRate);
+        voice.envelope.reset();
+        voice.note = -1;
+        voice.stealFade = 0;
+    }
+    numActive = 0;
+}
+
+void VoiceAllocator::setWavetables(const WavetableSet* tables)
+{
+    for (auto& voice : voices)
+        voice.synth.setWavetables(tables);
+}
+
+void VoiceAllocator::setMathAccuracy(MathAccuracy accuracy)
+{
+    for (auto& voice : voices)
+        voice.synth.setMathAccuracy(accuracy);
+}
+
+void VoiceAllocator::setVoiceParameters(OscType _oscType, LFOType _lfoType, float _lfoRate, float _lfoDepth,
+                                        FilterType _filterType, float _cutoff, float _resonance)
+{
+    oscType = _oscType;
+    lfoType = _lfoType;
+    lfoRate = _lfoRate;
+    lfoDepth = _lfoDepth;
+    filterType = _filterType;
+    cutoff = _cutoff;
+    resonance = _resonance;
+}
+
+void VoiceAllocator::setPulseWidth(float width, float modDepth)
+{
+    pulseWidth = width;
+    pulseWidthMod = modDepth;
+}
+
+void VoiceAllocator::setUnison(int numVoices, float detuneCents, float stereoWidth)
+{
+    unisonVoices = numVoices;
+    unisonDetune = detuneCents;
+    unisonWidth = stereoWidth;
+}
+
+void VoiceAllocator::setEnvelope(const juce::ADSR::Parameters& params)
+{
+    for (auto& voice : voices)
+        voice.envelope.setParameters(params);
+}
+
+int VoiceAllocator::findVoiceToUse(int note) const
+{
+    // 1. retrigger a voice already playing this note
+    for (int slot = 0; slot < numActive; slot++)
+        if (voices[activeVoices[slot]].note == note)
+            return activeVoices[slot];
+
+    // 2. any idle voice
+    if (numActive < maxVoices)
+    {
+        for (int v = 0; v < maxVoices; v++)
+        {
+            bool isActive = false;
+            for (int slot = 0; slot < numActive; slot++)
+                isActive = isActive || activeVoices[slot] == v;
+
+            if (! isActive)
+                return v;
+        }
+    }
+
+    // 3. steal the oldest voice, preferring one that is already releasing
+    int oldest = activeVoices[0];
+    int oldestReleased = -1;
+    for (int slot = 0; slot < numActive; slot++)
+    {
+        int v = activeVoices[slot];
+        if (voices[v].startOrder < voices[oldest].startOrder)
+            oldest = v;
+
+        if (voices[v].note < 0 && (oldestReleased < 0 || voices[v].startOrder < voices[oldestReleased].startOrder))
+            oldestReleased = v;
+    }
+
+    return oldestReleased >= 0 ? oldestReleased : oldest;
+}
+
+void VoiceAllocator::noteOn(int note, float velocity)
+{
+    int v = findVoiceToUse(note);
+    auto& voice = voices[v];
+
+    bool isActive = false;
+    for (int slot = 0; slot < numActive; slot++)
+        isActive = isActive || activeVoices[slot] == v;
+
+    voice.note = note;
+    voice.startOrder = noteCounter++;
+
+    if (isActive)
+    {
+        // Resetting a sounding voice's phases and filter would click: fade the old
+        // note out first, renderVoices starts this one when the fade is over
+        if (voice.stealFade == 0)
+            voice.stealFade = stealFadeLength;
+
+        voice.pendingNote = note;
+        voice.pendingVelocity = velocity;
+        return;
+    }
+
+    activeVoices[numActive++] = v;
+    startVoice(voice, note, velocity);
+}
+
+void VoiceAllocator::startVoice(Voice& voice, int note, float velocity)
+{
+    float frequency = (float) juce::MidiMessage::getMidiNoteInHertz(note);
+
+    // the LFO sweeps around the Cutoff parameter, as on the drone voices
+    voice.synth.setOSC(oscType, frequency, 0);
+    voice.synth.setLFO(lfoType, lfoRate, lfoDepth, 0);
+    voice.synth.setFilter(filterType, cutoff, resonance);
+    voice.synth.setPulseWidth(pulseWidth, pulseWidthMod);
+    voice.synth.setUnison(unisonVoices, unisonDetune, unisonWidth);
+
+    // a stolen voice's envelope would otherwise attack from where the old note left it
+    voice.velocity = velocity;
+    voice.envelope.reset();
+    voice.envelope.noteOn();
+}
+
+void VoiceAllocator::noteOff(int note)
+{
+    for (int slot = 0; slot < numActive; slot++)
+    {
+        auto& voice = voices[activeVoices[slot]];
+        if (voice.note == note)
+        {
+            voice.note = -1; // released, the envelope keeps it sounding until the tail ends
+            voice.envelope.noteOff();
+        }
+    }
+}
+
+void VoiceAllocator::allNotesOff()
+{
+    for (int slot = 0; slot < numActive; slot++)
+    {
+        auto& voice = voices[activeVoices[slot]];
+        voice.note = -1;
+        voice.envelope.noteOff();
+    }
+}
+
+void VoiceAllocator::handleMidiEvent(const juce::MidiMessage& message)
+{
+    if (message.isNoteOn())
+        noteOn(message.getNoteNumber(), message.getFloatVelocity());
+    else if (message.isNoteOff())
+        noteOff(message.getNoteNumber());
+    else if (message.isAllNotesOff() || message.isAllSoundOff())
+        allNotesOff();
+}
+
+void VoiceAllocator::deactivate(int slot)
+{
+    activeVoices[slot] = activeVoices[--numActive];
+}
+
+void VoiceAllocator::renderNextBlock(float* const* outputs, int numChannels, const juce::MidiBuffer& midi, int startSample, int numSamples)
+{
+    int pos = 0;
+
+    for (auto it = midi.findNextSamplePosition(startSample); it != midi.cend(); ++it)
+    {
+        const auto metadata = *it;
+        int eventPos = metadata.samplePosition - startSample;
+        if (eventPos >= numSamples)
+            break;
+
+        // render up to the event, then apply it
+        if (eventPos > pos)
+        {
+            renderVoices(outputs, numChannels, pos, eventPos - pos);
+            pos = eventPos;
+        }
+
+        handleMidiEvent(metadata.getMessage());
+    }
+
+    if (pos < numSamples)
+        renderVoices(outputs, numChannels, pos, numSamples - pos);
+}
+
+void VoiceAllocator::renderVoices(float* const* outputs, int numChannels, int offset, int numSamples)
+{
+    for (int start = 0; start < numSamples; start += maxChunkSize)
+    {
+        int n = juce::jmin(maxChunkSize, numSamples - start);
+
+        // only the active voices cost anything, walk backwards so finished ones can be removed
+        for (int slot = numActive - 1; slot >= 0; slot--)
+        {
+            auto& voice = voices[activeVoices[slot]];
+            int pos = 0;
+
+            // a stolen voice plays out its fade, then its new note starts, in this chunk if the fade ends here
+            if (voice.stealFade > 0)
+            {
+                pos = juce::jmin(n, voice.stealFade);
+                renderVoice(voice, outputs, numChannels, offset + start, pos);
+
+                if (voice.stealFade == 0 || ! voice.envelope.isActive())
+                {
+                    bool released = voice.note < 0; // note-off during the fade
+                    voice.stealFade = 0;
+                    startVoice(voice, voice.pendingNote, voice.pendingVelocity);
+
+                    if (released)
+                        voice.envelope.noteOff();
+                }
+            }
+
+            if (voice.stealFade == 0 && pos < n)
+                renderVoice(voice, outputs, numChannels, offset + start + pos, n - pos);
+
+            if (! voice.envelope.isActive())
+            {
+                voice.note = -1;
+                deactivate(slot);
+            }
+        }
+    }
+}
+
+void VoiceAllocator::renderVoice(Voice& voice, float* const* outputs, int numChannels, int offset, int numSamples)
+{
+    float level = voiceGain * voice.velocity;
+
+    // linear fade to silence while stolen, the caller never renders past its end
+    float fade = 1.0f, fadeStep = 0.0f;
+    if (voice.stealFade > 0)
+    {
+        jassert(numSamples <= voice.stealFade);
+        fadeStep = 1.0f / stealFadeLength;
+        fade = voice.stealFade * fadeStep;
+        voice.stealFade -= numSamples;
+    }
+
+    // the modulation buffer lines up with the outputs
+    voice.synth.setCutoffModulation(cutoffModulation != nullptr ? cutoffModulation + offset : nullptr);
+
+    if (voice.synth.getUnisonVoices() > 1 && numChannels > 1)
+    {
+        // unison spreads across the field, left on the even channels and right on the odd ones
+        voice.synth.process(voiceBuffer, voiceBufferRight, numSamples, false);
+
+        for (int i = 0; i < numSamples; i++)
+        {
+            float gain = level * fade * voice.envelope.getNextSample();
+            voiceBuffer[i] *= gain;
+            voiceBufferRight[i] *= gain;
+            fade -= fadeStep;
+        }
+
+        for (int channel = 0; channel < numChannels; channel++)
+            juce::FloatVectorOperations::add(outputs[channel] + offset,
+                                             channel % 2 == 0 ? voiceBuffer : voiceBufferRight, numSamples);
+    }
+    else
+    {
+        voice.synth.process(voiceBuffer, numSamples, false);
+
+        for (int i = 0; i < numSamples; i++)
+        {
+            voiceBuffer[i] *= level * fade * voice.envelope.getNextSample();
+            fade -= fadeStep;
+        }
+
+        // the MIDI voices are mono, every channel gets the same signal
+        for (int channel = 0; channel < numChannels; channel++)
+            juce::FloatVectorOperations::add(outputs[channel] + offset, voiceBuffer, numSamples);
+    }
+}
@@ -0,0 +1,94 @@
+/*
+  ==============================================================================
+
+    VoiceAllocator.h
+    Preallocated pool of FilterSynth voices played from MIDI, with voice
+    stealing and sample-accurate event handling.
+    Created: 17 Oct 2026 6:48:03pm
+    Author:  chenzuyu
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <JuceHeader.h>
+#include "FilterSynth.h"
+
+class VoiceAllocator
+{
+public:
+    static constexpr int maxVoices = 16;
+
+    VoiceAllocator();
+
+    void prepare(float sampleRate); // set up every voice in the pool, call from prepareToPlay
+    void setWavetables(const WavetableSet* tables); // for every voice, nullptr to compute the waveshapes
+    void setMathAccuracy(MathAccuracy accuracy); // for every voice, used when there are no tables
+    void setVoiceParameters(OscType oscType, LFOType lfoType, float lfoRate, float lfoDepth,
+                            FilterType filterType, float cutoff, float resonance); // used by the next note-on
+    void setPulseWidth(float width, float modDepth); // for the BLEP Pulse oscillator, used by the next note-on
+    void setUnison(int numVoices, float detuneCents, float stereoWidth); // stacked saws, used by the next note-on, 1 voice = off
+    void setEnvelope(const juce::ADSR::Parameters& params);
+
+    // Hz added to every voice's cutoff, per sample of the next renderNextBlock, nullptr for none
+    void setCutoffModulation(const float* modulation) { cutoffModulation = modulation; }
+
+    void noteOn(int note, float velocity);
+    void noteOff(int note);
+    void allNotesOff();
+    void handleMidiEvent(const juce::MidiMessage& message);
+
+    // Add the voices into every output channel, splitting the block at every MIDI
+    // event between startSample and startSample + numSamples of the host buffer
+    void renderNextBlock(float* const* outputs, int numChannels, const juce::MidiBuffer& midi, int startSample, int numSamples);
+
+    int getNumActiveVoices() const { return numActive; }
+
+private:
+    struct Voice
+    {
+        FilterSynth synth;
+        juce::ADSR envelope;
+        int note = -1;
+        float velocity = 0.0f;
+        juce::uint32 startOrder = 0; // when the note started, for stealing the oldest voice
+
+        // A stolen voice fades out over stealFadeLength samples before its new note starts
+        int stealFade = 0; // samples of the fade left, 0 when not fading
+        int pendingNote = -1;
+        float pendingVelocity = 0.0f;
+    };
+
+    void startVoice(Voice& voice, int note, float velocity); // reset the synth and start the envelope
+    void renderVoices(float* const* outputs, int numChannels, int offset, int numSamples);
+    void renderVoice(Voice& voice, float* const* outputs, int numChannels, int offset, int numSamples);
+    int findVoiceToUse(int note) const;
+    void deactivate(int slot); // remove activeVoices[slot] from the active list
+
+    Voice voices[maxVoices];
+    int activeVoices[maxVoices]; // indices into voices, only these are rendered
+    int numActive = 0;
+    juce::uint32 noteCounter = 0;
+
+    // Settings for new notes
+    OscType oscType = OscType::Square;
+    LFOType lfoType = LFOType::Saw;
+    float lfoRate = 0.1f;
+    float lfoDepth = 2200.0f;
+    FilterType filterType = FilterType::LowPass;
+    float cutoff = 2200.0f + 112.0f; // Hz, the LFO sweeps around it
+    float resonance = 0.7f;
+    float pulseWidth = 0.5f;
+    float pulseWidthMod = 0.0f;
+    int unisonVoices = 1;
+    float unisonDetune = 0.0f;
+    float unisonWidth = 1.0f;
+    float voiceGain = 0.25f; // headroom for chords
+    const float* cutoffModulation = nullptr;
+    int stealFadeLength = 240; // 5 ms, set by prepare
+
+    // Scratch space, blocks larger than this are split into chunks
+    static constexpr int maxChunkSize = 256;
+    float voiceBuffer[maxChunkSize];
+    float voiceBufferRight[maxChunkSize]; // unison voices are stereo
+};
@@ -0,0 +1,93 @@
+/*
+  ==============================================================================
+
+    Wavetable.cpp
+    Band-limited, mip-mapped wavetables baked from the oscillator waveshapes,
+    so the oscillators can read a table instead of calling sin/tanh/pow.
+    Created: 17 Oct 2026 2:05:18pm
+    Author:  chenzuyu
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "Wavetable.h"
+#include "Oscillator.h"
+
+void Wavetable::build(float (*shape)(float), WavetableQuality quality)
+{
+    int order = 11;
+    switch (quality)
+    {
+        case WavetableQuality::Low:
+            order = 9;
+            break;
+        case WavetableQuality::Medium:
+            order = 11;
+            break;
+        case WavetableQuality::High:
+            order = 13;
+            break;
+    }
+
+    tableSize = 1 << order;
+    indexShift = 32 - order;
+    fractionMask = (1u << indexShift) - 1;
+    fractionScale = 1.0f / (float) (1u << indexShift);
+    numLevels = order; // top harmonic tableSize/2 at level 0 down to 1 at the last level
+    tables.assign((size_t) (numLevels * (tableSize + 1)), 0.0f);
+
+    // Spectrum of one cycle of the raw waveshape
+    juce::dsp::FFT fft(order);
+    std::vector<float> spectrum((size_t) (2 * tableSize), 0.0f);
+    std::vector<float> work((size_t) (2 * tableSize), 0.0f);
+
+    for (int i = 0; i < tableSize; i++)
+        spectrum[(size_t) i] = shape((float) i / tableSize);
+
+    fft.performRealOnlyForwardTransform(spectrum.data());
+
+    int topHarmonic = tableSize / 2;
+    for (int level = 0; level < numLevels; level++)
+    {
+        // remove every harmonic above the top one, and its negative-frequency mirror
+        std::copy(spectrum.begin(), spectrum.end(), work.begin());
+        for (int bin = topHarmonic + 1; bin < tableSize - topHarmonic; bin++)
+        {
+            work[(size_t) (2 * bin)] = 0.0f;
+            work[(size_t) (2 * bin + 1)] = 0.0f;
+        }
+
+        fft.performRealOnlyInverseTransform(work.data());
+
+        float* table = tables.data() + level * (tableSize + 1);
+        std::copy(work.begin(), work.begin() + tableSize, table);
+        table[tableSize] = table[0]; // guard sample for the interpolation
+
+        topHarmonic /= 2;
+    }
+}
+
+int Wavetable::getLevelForIncrement(float phaseDelta) const
+{
+    // level k holds (tableSize/2 >> k) harmonics, pick the first one that stays below Nyquist
+    int level = 0;
+    float topHarmonic = tableSize / 2;
+
+    while (level < numLevels - 1 && topHarmonic * phaseDelta > 0.5f)
+    {
+        topHarmonic *= 0.5f;
+        level++;
+    }
+
+    return level;
+}
+
+void WavetableSet::build(WavetableQuality quality)
+{
+    sine.build(sineOSC::shape, quality);
+    saw.build(sawOSC::shape, quality);
+    sawExponential.build(sawOSC::shapeExponential, quality);
+    square.build(squareOSC::shape, quality);
+    triangle.build(triangleOSC::shape, quality);
+}
@@ -0,0 +1,82 @@
+/*
+  ==============================================================================
+
+    Wavetable.h
+    Band-limited, mip-mapped wavetables baked from the oscillator waveshapes,
+    so the oscillators can read a table instead of calling sin/tanh/pow.
+    Created: 17 Oct 2026 2:05:18pm
+    Author:  chenzuyu
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <vector>
+#include <cstdint>
+
+// Points per table, trading memory and build time for accuracy
+enum class WavetableQuality {
+    Low,     // 512 points
+    Medium,  // 2048 points
+    High     // 8192 points
+};
+
+class Wavetable
+{
+public:
+    // Bake a waveshape (phase in [0, 1] -> sample) into one table per octave,
+    // each one holding only the harmonics that fit below Nyquist at that octave.
+    // Allocates, so call it from prepareToPlay.
+    void build(float (*shape)(float), WavetableQuality quality);
+
+    bool isEmpty() const { return tables.empty(); }
+    int getTableSize() const { return tableSize; }
+
+    // Mip level for an oscillator advancing phaseDelta (frequency / sampleRate) per sample
+    int getLevelForIncrement(float phaseDelta) const;
+
+    // Linear interpolation into the given level, phase in [0, 1]
+    float read(int level, float phase) const
+    {
+        const float* table = tables.data() + level * (tableSize + 1);
+        float pos = phase * tableSize;
+        int index = (int) pos;
+        float frac = pos - index;
+        index &= tableSize - 1;
+
+        // the guard sample at table[tableSize] repeats table[0], so index + 1 never wraps
+        return table[index] + frac * (table[index + 1] - table[index]);
+    }
+
+    // Same read from a 32-bit fixed-point phase (2^32 is one cycle): the top
+    // bits are the index and the bits below them the fraction, no float-to-int conversion
+    float readFixed(int level, std::uint32_t phase) const
+    {
+        const float* table = tables.data() + level * (tableSize + 1);
+        std::uint32_t index = phase >> indexShift;
+        float frac = (float) (phase & fractionMask) * fractionScale;
+
+        return table[index] + frac * (table[index + 1] - table[index]);
+    }
+
+private:
+    int tableSize = 0;
+    int indexShift = 32; // 32 - log2(tableSize)
+    std::uint32_t fractionMask = 0;
+    float fractionScale = 0.0f; // 2^-indexShift
+    int numLevels = 0;
+    std::vector<float> tables; // numLevels tables of tableSize + 1 samples
+};
+
+// One table per oscillator waveshape, built together and shared between oscillators
+struct WavetableSet
+{
+    void build(WavetableQuality quality);
+
+    Wavetable sine;
+    Wavetable saw;
+    Wavetable sawExponential;
+    Wavetable square;
+    Wavetable triangle;
+};
@@ -0,0 +1,209 @@
+/*
+  ==============================================================================
+
+    WorkerPool.cpp
+    Optional pool of preallocated worker threads for rendering independent
+    chains in parallel. The audio thread hands out a block's tasks through
+    lock-free per-worker queues, works on them itself, steals from the others
+    and spins on an atomic counter until every task is done. The workers run
+    at real-time priority, in the host's audio workgroup where there is one.
+    Created: 17 Oct 2026 11:26:09pm
+    Author:  chenzuyu
+
+  ==============================================================================
+*/
+
+#include "WorkerPool.h"
+#include "AllocationTracker.h"
+
+#if JUCE_INTEL
+ #include <immintrin.h>
+#endif
+
+WorkerPool::~WorkerPool()
+{
+    stopWorkers();
+}
+
+void WorkerPool::setNumWorkers(int numWorkers, int blockSize, double sampleRate)
+{
+    numWorkers = juce::jlimit(0, maxWorkers, numWorkers);
+    if (numWorkers == (int) workers.size() && blockSize == workerBlockSize && sampleRate == workerSampleRate)
+        return;
+
+    stopWorkers();
+
+    numQueues = numWorkers + 1;
+    for (auto& queue : queues)
+        queue.range.store(0);
+
+    workerBlockSize = blockSize;
+    workerSampleRate = sampleRate;
+
+    // The audio thread spins on the tasks the workers have claimed: at a lower priority
+    // than it they could be preempted in the middle of one and stall the block
+    auto options = juce::Thread::RealtimeOptions{};
+    if (blockSize > 0 && sampleRate > 0.0)
+        options = options.withApproximateAudioProcessingTime(blockSize, sampleRate);
+
+    shouldExit = false;
+    workers.reserve((size_t) numWorkers);
+    for (int w = 0; w < numWorkers; w++)
+    {
+        workers.push_back(std::make_unique<Worker>(*this, w + 1));
+
+        // without the rights for a real-time thread (e.g. Linux without rtprio) the highest normal priority
+        if (! workers.back() -> startRealtimeThread(options))
+            workers.back() -> startThread(juce::Thread::Priority::highest);
+    }
+}
+
+void WorkerPool::setWorkgroup(const juce::AudioWorkgroup& newWorkgroup)
+{
+    const juce::ScopedLock lock(workgroupLock);
+    workgroup = newWorkgroup;
+    workgroupVersion++;
+
+    for (auto& worker : workers)
+        worker -> wakeUp.signal();
+}
+
+void WorkerPool::stopWorkers()
+{
+    shouldExit = true;
+    for (auto& worker : workers)
+    {
+        worker -> wakeUp.signal();
+        worker -> waitForThreadToExit(-1);
+    }
+
+    workers.clear();
+    numQueues = 1;
+}
+
+void WorkerPool::pause()
+{
+   #if JUCE_INTEL
+    _mm_pause();
+   #elif JUCE_ARM && (defined (__GNUC__) || defined (__clang__))
+    __asm__ __volatile__ ("yield");
+   #endif
+}
+
+void WorkerPool::runParallel(int numTasks, TaskFunction function, void* context)
+{
+    job = function;
+    jobContext = context;
+    tasksDone.store(0, std::memory_order_relaxed);
+
+    // contiguous ranges, one per queue; the release stores publish the job
+    for (int q = 0; q < numQueues; q++)
+    {
+        auto begin = (juce::uint64) (q * numTasks / numQueues);
+        auto end = (juce::uint64) ((q + 1) * numTasks / numQueues);
+        queues[q].range.store((end << 32) | begin, std::memory_order_release);
+    }
+
+    // sequentially consistent, paired with the sleeping flags in workerLoop: either a
+    // worker sees the new generation before it sleeps, or its flag is seen here
+    generation.fetch_add(1);
+    for (auto& worker : workers)
+        if (worker -> sleeping.load())
+            worker -> wakeUp.signal();
+
+    // the audio thread works too, so the block completes even if no worker wakes up in time
+    executeTasks(0);
+
+    // barrier: wait for the tasks other threads have claimed
+    while (tasksDone.load(std::memory_order_acquire) < numTasks)
+        pause();
+}
+
+int WorkerPool::claimTask(int queue)
+{
+    auto& range = queues[queue].range;
+    auto value = range.load(std::memory_order_acquire);
+
+    for (;;)
+    {
+        auto next = (int) (value & 0xffffffff);
+        auto end = (int) (value >> 32);
+        if (next >= end)
+            return -1;
+
+        if (range.compare_exchange_weak(value, value + 1, std::memory_order_acq_rel, std::memory_order_acquire))
+            return next;
+    }
+}
+
+void WorkerPool::executeTasks(int firstQueue)
+{
+    DRONE_REALTIME_SCOPE; // the tasks are part of processBlock, on the workers too
+
+    // own queue first, then steal from the others
+    for (int k = 0; k < numQueues; k++)
+    {
+        int queue = (firstQueue + k) % numQueues;
+
+        for (int task = claimTask(queue); task >= 0; task = claimTask(queue))
+        {
+            job(jobContext, task);
+            tasksDone.fetch_add(1, std::memory_order_release);
+        }
+    }
+}
+
+void WorkerPool::workerLoop(Worker& worker)
+{
+    juce::ScopedNoDenormals noDenormals; // same floating point mode as the audio thread
+    juce::WorkgroupToken token;
+    int joinedVersion = -1;
+    auto seenGeneration = generation.load(std::memory_order_acquire);
+    int idleSpins = 0;
+
+    while (! shouldExit.load(std::memory_order_relaxed))
+    {
+        if (joinedVersion != workgroupVersion.load(std::memory_order_acquire))
+            joinWorkgroup(token, joinedVersion);
+
+        auto currentGeneration = generation.load(std::memory_order_acquire);
+
+        if (currentGeneration == seenGeneration)
+        {
+            // spin for the next block, then back off so an idle pool costs little
+            if (++idleSpins < 4000)
+            {
+                pause();
+            }
+            else if (idleSpins < 40000)
+            {
+                juce::Thread::yield();
+            }
+            else
+            {
+                // sleep until runParallel signals, the timeout only to notice shouldExit
+                worker.sleeping.store(true);
+                if (generation.load() == seenGeneration)
+                    worker.wakeUp.wait(100);
+                worker.sleeping.store(false);
+            }
+
+            continue;
+        }
+
+        seenGeneration = currentGeneration;
+        idleSpins = 0;
+        executeTasks(worker.queue);
+    }
+}
+
+void WorkerPool::joinWorkgroup(juce::WorkgroupToken& token, int& joinedVersion)
+{
+    // joining applies to the calling thread, so every worker does it for itself
+    const juce::ScopedLock lock(workgroupLock);
+    token.reset();
+    if (workgroup)
+        workgroup.join(token);
+
+    joinedVersion = workgroupVersion.load();
+}
@@ -0,0 +1,108 @@
+/*
+  ==============================================================================
+
+    WorkerPool.h
+    Optional pool of preallocated worker threads for rendering independent
+    chains in parallel. The audio thread hands out a block's tasks through
+    lock-free per-worker queues, works on them itself, steals from the others
+    and spins on an atomic counter until every task is done. The workers run
+    at real-time priority, in the host's audio workgroup where there is one.
+    Created: 17 Oct 2026 11:26:09pm
+    Author:  chenzuyu
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <JuceHeader.h>
+#include <atomic>
+
+class WorkerPool
+{
+public:
+    static constexpr int maxWorkers = 8;
+    static constexpr int minSamplesForParallel = 128; // smaller blocks render serially
+
+    WorkerPool() = default;
+    ~WorkerPool();
+
+    // Start or stop threads, not real-time safe: call from prepareToPlay. The block size and
+    // sample rate tell the scheduler how often the workers run, 0 for no hint
+    void setNumWorkers(int numWorkers, int blockSize = 0, double sampleRate = 0.0);
+    int getNumWorkers() const { return (int) workers.size(); }
+
+    // The host's audio workgroup (macOS), the workers join it the next time they wake.
+    // Not real-time safe
+    void setWorkgroup(const juce::AudioWorkgroup& newWorkgroup);
+
+    // Run task(0) .. task(numTasks - 1) and return once all of them are done.
+    // Real-time safe: no locks and no allocation. Runs serially on the calling
+    // thread when there are no workers, one task, or fewer than
+    // minSamplesForParallel samples of work in each task. The calling thread only
+    // waits for tasks a worker has started, every other task it takes itself.
+    // Waking a worker that went to sleep after an idle spell is one system call
+    template <typename Function>
+    void run(int numTasks, int numSamples, Function&& task)
+    {
+        if (workers.empty() || numTasks <= 1 || numSamples < minSamplesForParallel)
+        {
+            for (int t = 0; t < numTasks; t++)
+                task(t);
+            return;
+        }
+
+        using FunctionType = typename std::remove_reference<Function>::type;
+        runParallel(numTasks, [] (void* context, int t) { (*static_cast<FunctionType*>(context))(t); }, &task);
+    }
+
+private:
+    using TaskFunction = void (*)(void* context, int task);
+
+    class Worker : public juce::Thread
+    {
+    public:
+        Worker(WorkerPool& p, int q) : juce::Thread("Drone worker " + juce::String(q)), pool(p), queue(q) {}
+        void run() override { pool.workerLoop(*this); }
+
+        WorkerPool& pool;
+        const int queue;
+        juce::WaitableEvent wakeUp; // after backing off from spinning
+        std::atomic<bool> sleeping { false };
+    };
+
+    void runParallel(int numTasks, TaskFunction function, void* context);
+    void executeTasks(int firstQueue);
+    int claimTask(int queue);
+    void workerLoop(Worker& worker);
+    void joinWorkgroup(juce::WorkgroupToken& token, int& joinedVersion);
+    void stopWorkers();
+    static void pause();
+
+    // One range of task indices per queue, end << 32 | next, on its own cache line.
+    // Queue 0 belongs to the audio thread, queue w + 1 to worker w
+    struct alignas(64) Queue
+    {
+        std::atomic<juce::uint64> range { 0 };
+    };
+
+    Queue queues[maxWorkers + 1];
+    int numQueues = 1;
+
+    // The current job, published by the release stores of the queue ranges
+    TaskFunction job = nullptr;
+    void* jobContext = nullptr;
+
+    alignas(64) std::atomic<int> tasksDone { 0 };
+    alignas(64) std::atomic<juce::uint32> generation { 0 }; // bumped for every parallel run
+    std::atomic<bool> shouldExit { false };
+
+    std::vector<std::unique_ptr<Worker>> workers;
+    int workerBlockSize = 0;
+    double workerSampleRate = 0.0;
+
+    juce::CriticalSection workgroupLock; // the workers and setWorkgroup only, never the audio thread
+    juce::AudioWorkgroup workgroup;
+    std::atomic<int> workgroupVersion { 0 };
+
+    JUCE_DECLARE_NON_COPYABLE (WorkerPool)
+};
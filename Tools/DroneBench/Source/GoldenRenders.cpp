@@ -0,0 +1,307 @@
+/*
+  ==============================================================================
+
+    GoldenRenders.cpp
+    Regression check for the DSP hot paths: renders a fixed length from every
+    oscillator, every FilterType, both Delay modes and the reverb, null-tests
+    each against a stored reference WAV and times the render, so that a
+    speedup which changes the sound shows up in the same run.
+    Created: 17 Oct 2026 10:58:34pm
+    Author:  chenzuyu
+
+  ==============================================================================
+*/
+
+#include "GoldenRenders.h"
+#include "../../../Source/PluginProcessor.h"
+
+namespace
+{
+    constexpr double goldenSeconds = 2.0; // long enough for the slow LFOs to sweep
+
+    // One render: fills a mono buffer block by block, only the block calls are timed
+    struct GoldenCase
+    {
+        juce::String name;
+        std::function<void(float* dest, int numSamples)> render;
+    };
+
+    // Every oscillator type, computed waveshapes at a fixed frequency and phase
+    template <typename OscT>
+    GoldenCase makeOscillatorCase(const juce::String& name, const GoldenSettings& settings,
+                                  std::function<void(OscT&, float*, int)> render = nullptr,
+                                  std::shared_ptr<OscT> osc = std::make_shared<OscT>())
+    {
+        osc->setSampleRate((float) settings.sampleRate);
+        osc->setFrequency(110.0f);
+        osc->setGain(1.0f);
+        osc->setPhase(0.0f);
+
+        if (render == nullptr)
+            render = [](OscT& o, float* dest, int numSamples) { o.process(dest, numSamples); };
+
+        return { name, [osc, render](float* dest, int numSamples) { render(*osc, dest, numSamples); } };
+    }
+
+    // A saw through each filter, the cutoff swept by a saw LFO as in the drone voices
+    GoldenCase makeFilterCase(const juce::String& name, FilterType type, const GoldenSettings& settings)
+    {
+        auto synth = std::make_shared<FilterSynth>();
+        synth->setSampleRate((float) settings.sampleRate);
+        synth->setOSC(OscType::Saw, 110, 0);
+        synth->setLFO(LFOType::Saw, 0.5f, 2200, 0);
+        synth->setFilter(type, 2200 + 112, 0.7f);
+        synth->setControlRate(32);
+
+        return { name, [synth](float* dest, int numSamples) { synth->process(dest, numSamples, true); } };
+    }
+
+    // A saw through the block Delay::process, delay time and gain swept by slow LFOs
+    GoldenCase makeDelayCase(const juce::String& name, DelayInterpolation interpolation, bool feedBack,
+                             const GoldenSettings& settings)
+    {
+        struct DelayRender
+        {
+            sawOSC input, feedbackLFO, delayLFO;
+            Delay delay;
+            juce::AudioBuffer<float> mods;
+        };
+
+        auto state = std::make_shared<DelayRender>();
+        for (auto* osc : std::vector<Oscillator*> { &state->input, &state->feedbackLFO, &state->delayLFO })
+        {
+            osc->setSampleRate((float) settings.sampleRate);
+            osc->setPhase(0.0f);
+        }
+        state->input.setFrequency(110.0f);
+        state->feedbackLFO.setFrequency(0.5f);
+        state->delayLFO.setFrequency(0.25f);
+        state->delay.setBufferSize((int) settings.sampleRate);
+        state->delay.setInterpolation(interpolation);
+        state->mods.setSize(2, settings.blockSize);
+
+        return { name, [state, feedBack](float* dest, int numSamples)
+        {
+            auto* feedbackGains = state->mods.getWritePointer(0);
+            auto* delayTimes = state->mods.getWritePointer(1);
+
+            state->input.process(dest, numSamples);
+            state->feedbackLFO.process(feedbackGains, numSamples, true);
+            state->delayLFO.process(delayTimes, numSamples, true);
+            juce::FloatVectorOperations::multiply(delayTimes, 2000.0f, numSamples);
+            juce::FloatVectorOperations::add(delayTimes, 2000.0f, numSamples);
+
+            state->delay.process(dest, dest, numSamples, delayTimes, feedbackGains, feedBack);
+        } };
+    }
+
+    // A short saw burst into the reverb, so most of the render is the tail
+    GoldenCase makeReverbCase(const juce::String& name, FDNMixing mixing, const GoldenSettings& settings)
+    {
+        struct ReverbRender
+        {
+            sawOSC input;
+            MemoryArena arena;
+            FDNReverb reverb;
+            int samplesLeft = 0;
+        };
+
+        auto state = std::make_shared<ReverbRender>();
+        state->input.setSampleRate((float) settings.sampleRate);
+        state->input.setFrequency(110.0f);
+        state->input.setPhase(0.0f);
+        state->arena.reserve(FDNReverb::getRequiredMemory(settings.sampleRate));
+        state->reverb.setMixing(mixing);
+        state->reverb.setDecayTime(2.0f); // before prepare, so neither ramps
+        state->reverb.setDamping(6000.0f);
+        state->reverb.setMix(1.0f);
+        state->reverb.prepare(settings.sampleRate, settings.sampleRate, state->arena);
+        state->samplesLeft = (int) (0.1 * settings.sampleRate);
+
+        return { name, [state](float* dest, int numSamples)
+        {
+            state->input.process(dest, numSamples);
+            int burst = juce::jlimit(0, numSamples, state->samplesLeft);
+            std::fill(dest + burst, dest + numSamples, 0.0f);
+            state->samplesLeft -= burst;
+
+            state->reverb.process(dest, nullptr, numSamples);
+        } };
+    }
+
+    std::vector<GoldenCase> makeGoldenCases(const GoldenSettings& settings)
+    {
+        std::vector<GoldenCase> cases;
+
+        cases.push_back(makeOscillatorCase<sineOSC>("osc-sine", settings));
+        cases.push_back(makeOscillatorCase<sawOSC>("osc-saw", settings));
+        cases.push_back(makeOscillatorCase<sawOSC>("osc-saw-exp", settings, [](sawOSC& o, float* dest, int numSamples)
+        {
+            o.process(dest, numSamples, true);
+        }));
+        cases.push_back(makeOscillatorCase<squareOSC>("osc-square", settings));
+        cases.push_back(makeOscillatorCase<triangleOSC>("osc-triangle", settings));
+        cases.push_back(makeOscillatorCase<blepSawOSC>("osc-blep-saw", settings));
+        auto blepPulse = std::make_shared<blepPulseOSC>();
+        blepPulse->setPulseWidth(0.25f);
+        cases.push_back(makeOscillatorCase<blepPulseOSC>("osc-blep-pulse", settings, nullptr, blepPulse));
+        cases.push_back(makeOscillatorCase<blampTriangleOSC>("osc-blamp-triangle", settings));
+
+        // the fixed-point phase accumulator, as the processor runs its modulators
+        auto fixedSaw = std::make_shared<sawOSC>();
+        fixedSaw->setFixedPointPhase(true);
+        cases.push_back(makeOscillatorCase<sawOSC>("osc-saw-fixed-phase", settings, nullptr, fixedSaw));
+        auto fixedSquare = std::make_shared<squareOSC>();
+        fixedSquare->setFixedPointPhase(true);
+        cases.push_back(makeOscillatorCase<squareOSC>("osc-square-fixed-phase", settings, nullptr, fixedSquare));
+
+        const std::pair<FilterType, const char*> filters[] = {
+            { FilterType::LowPass, "filter-lowpass" },
+            { FilterType::HighPass, "filter-highpass" },
+            { FilterType::BandPass, "filter-bandpass" },
+            { FilterType::AllPass, "filter-allpass" },
+            { FilterType::SVFLowPass, "filter-svf-lowpass" },
+            { FilterType::SVFHighPass, "filter-svf-highpass" },
+            { FilterType::SVFBandPass, "filter-svf-bandpass" },
+            { FilterType::SVFNotch, "filter-svf-notch" }
+        };
+        for (auto& filter : filters)
+            cases.push_back(makeFilterCase(filter.second, filter.first, settings));
+
+        const std::pair<DelayInterpolation, const char*> interpolations[] = {
+            { DelayInterpolation::None, "none" },
+            { DelayInterpolation::Linear, "linear" },
+            { DelayInterpolation::Hermite, "hermite" },
+            { DelayInterpolation::Lagrange3, "lagrange3" },
+            { DelayInterpolation::Thiran, "thiran" }
+        };
+        for (bool feedBack : { true, false })
+            for (auto& interpolation : interpolations)
+                cases.push_back(makeDelayCase(juce::String(feedBack ? "delay-feedback-" : "delay-feedforward-") + interpolation.second,
+                                              interpolation.first, feedBack, settings));
+
+        cases.push_back(makeReverbCase("reverb-hadamard", FDNMixing::Hadamard, settings));
+        cases.push_back(makeReverbCase("reverb-householder", FDNMixing::Householder, settings));
+
+        return cases;
+    }
+
+    // Peak of the sample differences, a length mismatch fails outright
+    float getPeakDifference(const juce::AudioBuffer<float>& audio, const juce::AudioBuffer<float>& reference)
+    {
+        if (audio.getNumSamples() != reference.getNumSamples() || audio.getNumChannels() != reference.getNumChannels())
+            return std::numeric_limits<float>::infinity();
+
+        float peak = 0.0f;
+        for (int ch = 0; ch < audio.getNumChannels(); ch++)
+            for (int i = 0; i < audio.getNumSamples(); i++)
+                peak = juce::jmax(peak, std::abs(audio.getSample(ch, i) - reference.getSample(ch, i)));
+
+        return peak;
+    }
+}
+
+//==============================================================================
+bool writeWavFile(const juce::File& file, const juce::AudioBuffer<float>& audio, double sampleRate)
+{
+    file.deleteFile();
+    std::unique_ptr<juce::FileOutputStream> stream(file.createOutputStream());
+    if (stream == nullptr)
+        return false;
+
+    juce::WavAudioFormat wav;
+    std::unique_ptr<juce::AudioFormatWriter> writer(wav.createWriterFor(stream.get(), sampleRate,
+                                                                        (unsigned int) audio.getNumChannels(),
+                                                                        32, {}, 0));
+    if (writer == nullptr)
+        return false;
+
+    stream.release(); // the writer owns the stream now
+    return writer->writeFromAudioSampleBuffer(audio, 0, audio.getNumSamples());
+}
+
+bool readWavFile(const juce::File& file, juce::AudioBuffer<float>& audio)
+{
+    juce::AudioFormatManager formats;
+    formats.registerBasicFormats();
+    std::unique_ptr<juce::AudioFormatReader> reader(formats.createReaderFor(file));
+    if (reader == nullptr)
+        return false;
+
+    audio.setSize((int) reader->numChannels, (int) reader->lengthInSamples);
+    return reader->read(&audio, 0, (int) reader->lengthInSamples, 0, true, true);
+}
+
+int runGoldenRenders(const GoldenSettings& settings)
+{
+    if (! settings.directory.createDirectory())
+    {
+        std::cout << "Cannot create " << settings.directory.getFullPathName() << std::endl;
+        return 1;
+    }
+
+    auto numSamples = (int) (goldenSeconds * settings.sampleRate);
+    int numFailed = 0;
+
+    std::cout << "Golden renders, " << juce::String(settings.sampleRate, 0) << " Hz, block " << settings.blockSize
+              << ", tolerance " << juce::Decibels::toString(juce::Decibels::gainToDecibels(settings.tolerance, -200.0f))
+              << std::endl;
+    std::cout << "    " << juce::String("case").paddedRight(' ', 28) << juce::String("result").paddedRight(' ', 10)
+              << juce::String("peak diff").paddedLeft(' ', 12) << juce::String("ns/sample").paddedLeft(' ', 12) << std::endl;
+
+    for (auto& golden : makeGoldenCases(settings))
+    {
+        juce::AudioBuffer<float> audio(1, numSamples);
+        juce::int64 ticks = 0;
+
+        for (int pos = 0; pos < numSamples; pos += settings.blockSize)
+        {
+            int n = juce::jmin(settings.blockSize, numSamples - pos);
+
+            auto startTicks = juce::Time::getHighResolutionTicks();
+            golden.render(audio.getWritePointer(0, pos), n);
+            ticks += juce::Time::getHighResolutionTicks() - startTicks;
+        }
+
+        auto file = settings.directory.getChildFile(golden.name + ".wav");
+        juce::String result;
+        float peak = 0.0f;
+
+        juce::AudioBuffer<float> reference;
+        if (settings.update)
+        {
+            result = writeWavFile(file, audio, settings.sampleRate) ? "written" : "unwritable";
+            if (result == "unwritable")
+                numFailed++;
+        }
+        else if (! file.existsAsFile())
+        {
+            // a new case, or the wrong directory: nothing was compared, so it cannot pass
+            result = "missing";
+            numFailed++;
+        }
+        else if (! readWavFile(file, reference))
+        {
+            result = "unreadable";
+            numFailed++;
+        }
+        else
+        {
+            peak = getPeakDifference(audio, reference);
+            bool passed = peak <= settings.tolerance;
+            result = passed ? "ok" : "FAILED";
+            if (! passed)
+                numFailed++;
+        }
+
+        double seconds = juce::Time::highResolutionTicksToSeconds(ticks);
+        std::cout << "    " << golden.name.paddedRight(' ', 28) << result.paddedRight(' ', 10)
+                  << juce::Decibels::toString(juce::Decibels::gainToDecibels(peak, -200.0f)).paddedLeft(' ', 12)
+                  << juce::String(seconds * 1.0e9 / (double) numSamples, 2).paddedLeft(' ', 12) << std::endl;
+    }
+
+    std::cout << (numFailed == 0 ? "All golden renders passed" : juce::String(numFailed) + " golden renders failed") << std::endl;
+    if (numFailed > 0 && ! settings.update)
+        std::cout << "Missing references are rendered with --update, check the sound before committing them" << std::endl;
+    return numFailed;
+}
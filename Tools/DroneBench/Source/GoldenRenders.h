@@ -0,0 +1,33 @@
+/*
+  ==============================================================================
+
+    GoldenRenders.h
+    Regression check for the DSP hot paths: renders a fixed length from every
+    oscillator, every FilterType, both Delay modes and the reverb, null-tests
+    each against a stored reference WAV and times the render, so that a
+    speedup which changes the sound shows up in the same run.
+    Created: 17 Oct 2026 10:58:34pm
+    Author:  chenzuyu
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <JuceHeader.h>
+
+struct GoldenSettings
+{
+    juce::File directory;      // one reference WAV per case
+    bool update = false;       // rewrite the references instead of comparing
+    float tolerance = 1.0e-3f; // largest peak difference that passes, 0 is bit-exact, see Golden/ReadMe.txt
+    double sampleRate = 48000.0;
+    int blockSize = 512;
+};
+
+// Prints one line per case, returns the number of cases that failed.
+// A missing reference fails the case, --update (settings.update) writes it
+int runGoldenRenders(const GoldenSettings& settings);
+
+// 32-bit float WAV, so that the samples read back bit-exact
+bool writeWavFile(const juce::File& file, const juce::AudioBuffer<float>& audio, double sampleRate);
+bool readWavFile(const juce::File& file, juce::AudioBuffer<float>& audio);
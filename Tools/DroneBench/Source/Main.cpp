@@ -0,0 +1,648 @@
+/*
+  ==============================================================================
+
+    Main.cpp
+    DroneBench: headless offline renderer and benchmark for the Drone DSP graph.
+    Renders DroneAudioProcessor for a number of seconds at each sample rate and
+    block size, reports ns/sample and the real-time factor and the share of
+    each step of processBlock, as timed inside the processor. Compares the cost
+    of the delay interpolators and of the FilterSynth render paths, the FastMath accuracy tiers, the unison
+    stack and the reverb mixing matrices and can write the render to a WAV file.
+    With --golden it instead runs the regression renders of GoldenRenders.h
+    against the references in Tools/DroneBench/Golden and exits non-zero when
+    a case fails or has no reference.
+
+    Usage:
+      DroneBench [--seconds=10] [--rates=44100,48000,96000] [--blocks=64,512]
+                 [--chord=48,55,60] [--oversampling=0..3] [--channels=2]
+                 [--threads=0]
+                 [--wav=out.wav] [--null=reference.wav]
+      DroneBench --golden=Tools/DroneBench/Golden [--tolerance=0.001] [--update]
+
+    Created: 17 Oct 2026 4:31:52pm
+    Author:  chenzuyu
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "../../../Source/PluginProcessor.h"
+#include "GoldenRenders.h"
+
+//==============================================================================
+struct BenchSettings
+{
+    double seconds = 10.0;
+    juce::Array<double> sampleRates { 48000.0 };
+    juce::Array<int> blockSizes { 512 };
+    juce::Array<int> chordNotes; // MIDI notes held from the first sample
+    int oversampling = 0; // 0: off, 1: 2x, 2: 4x, 3: 8x
+    int numChannels = 2;  // output channels, one drone voice each
+    int numWorkerThreads = 0;
+    juce::File wavFile;
+    juce::File referenceFile;
+    GoldenSettings golden; // regression renders, run instead of the benchmark when a directory is given
+};
+
+// Times one stage of the graph and accumulates seconds spent in it
+class StageTimer
+{
+public:
+    void start() { startTicks = juce::Time::getHighResolutionTicks(); }
+    void stop() { ticks += juce::Time::getHighResolutionTicks() - startTicks; }
+    double getSeconds() const { return juce::Time::highResolutionTicksToSeconds(ticks); }
+
+private:
+    juce::int64 startTicks = 0;
+    juce::int64 ticks = 0;
+};
+
+static void printStage(const juce::String& name, double seconds, juce::int64 numSamples)
+{
+    std::cout << "    " << name.paddedRight(' ', 14)
+              << juce::String(seconds * 1.0e9 / (double) numSamples, 2).paddedLeft(' ', 10) << " ns/sample" << std::endl;
+}
+
+//==============================================================================
+// Render the whole processor, optionally keeping the output for the WAV file
+static double renderProcessor(double sampleRate, int blockSize, juce::int64 numSamples,
+                              const BenchSettings& settings, juce::AudioBuffer<float>* capture,
+                              double (*stepSeconds)[PerformanceMonitor::numSteps] = nullptr)
+{
+    DroneAudioProcessor processor;
+    if (auto* oversampling = processor.apvts.getParameter("oversampling"))
+        oversampling->setValueNotifyingHost(oversampling->convertTo0to1((float) settings.oversampling));
+    if (auto* workerThreads = processor.apvts.getParameter("workerThreads"))
+        workerThreads->setValueNotifyingHost(workerThreads->convertTo0to1((float) settings.numWorkerThreads));
+
+    processor.setPlayConfigDetails(settings.numChannels, settings.numChannels, sampleRate, blockSize);
+    processor.prepareToPlay(sampleRate, blockSize);
+
+    juce::AudioBuffer<float> buffer(settings.numChannels, blockSize);
+    juce::MidiBuffer midi;
+
+    if (capture != nullptr)
+        capture->setSize(settings.numChannels, (int) numSamples);
+
+    juce::int64 ticks = 0;
+    for (juce::int64 pos = 0; pos < numSamples; pos += blockSize)
+    {
+        int n = (int) juce::jmin((juce::int64) blockSize, numSamples - pos);
+        buffer.setSize(settings.numChannels, n, false, false, true);
+        buffer.clear();
+
+        midi.clear();
+        if (pos == 0)
+            for (auto note : settings.chordNotes)
+                midi.addEvent(juce::MidiMessage::noteOn(1, note, 0.8f), 0);
+
+        auto startTicks = juce::Time::getHighResolutionTicks();
+        processor.processBlock(buffer, midi);
+        ticks += juce::Time::getHighResolutionTicks() - startTicks;
+
+        if (capture != nullptr)
+            for (int ch = 0; ch < settings.numChannels; ch++)
+                capture->copyFrom(ch, (int) pos, buffer, ch, 0, n);
+    }
+
+    if (stepSeconds != nullptr)
+        for (int step = 0; step < PerformanceMonitor::numSteps; step++)
+            (*stepSeconds)[step] = processor.getPerformanceMonitor().getStepSeconds((PerformanceMonitor::Step) step);
+
+    processor.releaseResources();
+    return juce::Time::highResolutionTicksToSeconds(ticks);
+}
+
+// Where the time of renderProcessor went, as timed by processBlock itself
+static void printSteps(const double (&stepSeconds)[PerformanceMonitor::numSteps], juce::int64 numSamples)
+{
+    if (! PerformanceMonitor::hasSteps())
+    {
+        std::cout << "    (build with DRONE_BENCH_STAGES=1 for the time per step)" << std::endl;
+        return;
+    }
+
+    const char* names[PerformanceMonitor::numSteps] = {
+        "modulators", "drone voices", "midi voices", "delay lines", "reverb", "output mix", "limiter"
+    };
+
+    for (int step = 0; step < PerformanceMonitor::numSteps; step++)
+        printStage(names[step], stepSeconds[step], numSamples);
+}
+
+// Cost per sample of each delay interpolator, on the swept delay time of processBlock
+static void benchDelayInterpolation(double sampleRate, int blockSize, juce::int64 numSamples)
+{
+    const std::pair<DelayInterpolation, const char*> modes[] = {
+        { DelayInterpolation::None, "none" },
+        { DelayInterpolation::Linear, "linear" },
+        { DelayInterpolation::Hermite, "hermite" },
+        { DelayInterpolation::Lagrange3, "lagrange3" },
+        { DelayInterpolation::Thiran, "thiran" }
+    };
+
+    std::cout << "  delay interpolation:" << std::endl;
+
+    for (auto& mode : modes)
+    {
+        sawOSC input, feedbackLFO, delayLFO;
+        for (auto* osc : std::vector<Oscillator*> { &input, &feedbackLFO, &delayLFO })
+            osc->setSampleRate((float) sampleRate);
+        input.setFrequency(110.0f);
+        feedbackLFO.setFrequency(0.01f);
+        delayLFO.setFrequency(0.01f);
+
+        Delay delay;
+        delay.setBufferSize((int) sampleRate);
+        delay.setInterpolation(mode.first);
+
+        juce::AudioBuffer<float> buffer(3, blockSize);
+        StageTimer timer;
+
+        for (juce::int64 pos = 0; pos < numSamples; pos += blockSize)
+        {
+            int n = (int) juce::jmin((juce::int64) blockSize, numSamples - pos);
+            auto* audio = buffer.getWritePointer(0);
+            auto* feedbackGains = buffer.getWritePointer(1);
+            auto* delayTimes = buffer.getWritePointer(2);
+
+            input.process(audio, n);
+            feedbackLFO.process(feedbackGains, n, true);
+            delayLFO.process(delayTimes, n, true);
+            juce::FloatVectorOperations::multiply(delayTimes, 2000.0f, n);
+            juce::FloatVectorOperations::add(delayTimes, 2000.0f, n);
+
+            timer.start();
+            delay.process(audio, audio, n, delayTimes, feedbackGains, true);
+            timer.stop();
+        }
+
+        printStage(mode.second, timer.getSeconds(), numSamples);
+    }
+}
+
+// Cost per sample of the block render of each oscillator, the tanh-shaped ones against PolyBLEP/BLAMP
+static void benchOscillators(double sampleRate, int blockSize, juce::int64 numSamples)
+{
+    sawOSC saw;
+    squareOSC square;
+    triangleOSC triangle;
+    blepSawOSC blepSaw;
+    blepPulseOSC blepPulse;
+    blampTriangleOSC blampTriangle;
+    blepPulse.setPulseWidth(0.25f);
+
+    const std::pair<Oscillator*, const char*> oscillators[] = {
+        { &saw, "tanh saw" },
+        { &square, "tanh square" },
+        { &triangle, "triangle" },
+        { &blepSaw, "polyblep saw" },
+        { &blepPulse, "polyblep pulse" },
+        { &blampTriangle, "polyblamp triangle" }
+    };
+
+    std::cout << "  oscillators:" << std::endl;
+
+    juce::HeapBlock<float> buffer((size_t) blockSize);
+
+    for (auto& osc : oscillators)
+    {
+        osc.first->setSampleRate((float) sampleRate);
+        osc.first->setFrequency(110.0f);
+        osc.first->setGain(1.0f);
+
+        StageTimer timer;
+        for (juce::int64 pos = 0; pos < numSamples; pos += blockSize)
+        {
+            int n = (int) juce::jmin((juce::int64) blockSize, numSamples - pos);
+
+            timer.start();
+            osc.first->process(buffer, n);
+            timer.stop();
+        }
+
+        printStage(osc.second, timer.getSeconds(), numSamples);
+    }
+}
+
+// Cycles per sample of each FastMath kernel and of the computed oscillators in each accuracy tier
+static void benchMathAccuracy(double sampleRate, int blockSize, juce::int64 numSamples)
+{
+    const std::pair<MathAccuracy, const char*> tiers[] = {
+        { MathAccuracy::Exact, "exact" },
+        { MathAccuracy::High, "high" },
+        { MathAccuracy::Fast, "fast" }
+    };
+
+    // the cycle count assumes the core runs at its nominal clock
+    double cyclesPerNanosecond = juce::SystemStats::getCpuSpeedInMegahertz() / 1000.0;
+    auto printCycles = [&](const juce::String& name, double seconds)
+    {
+        std::cout << "    " << name.paddedRight(' ', 20)
+                  << juce::String(seconds * 1.0e9 / (double) numSamples, 2).paddedLeft(' ', 10) << " ns/sample"
+                  << juce::String(seconds * 1.0e9 * cyclesPerNanosecond / (double) numSamples, 1).paddedLeft(' ', 10) << " cycles/sample"
+                  << std::endl;
+    };
+
+    std::cout << "  math accuracy:" << std::endl;
+
+    juce::HeapBlock<float> input((size_t) blockSize), buffer((size_t) blockSize);
+    for (int i = 0; i < blockSize; i++)
+        input[i] = (float) i / blockSize; // a ramp over 0 ~ 1, in range for all three kernels
+
+    for (auto& tier : tiers)
+    {
+        StageTimer tanhTimer, sinTimer, exp2Timer;
+
+        for (juce::int64 pos = 0; pos < numSamples; pos += blockSize)
+        {
+            int n = (int) juce::jmin((juce::int64) blockSize, numSamples - pos);
+
+            tanhTimer.start();
+            switch (tier.first)
+            {
+                case MathAccuracy::Exact: FastMath::tanh<MathAccuracy::Exact>(input, buffer, n); break;
+                case MathAccuracy::High:  FastMath::tanh<MathAccuracy::High>(input, buffer, n); break;
+                case MathAccuracy::Fast:  FastMath::tanh<MathAccuracy::Fast>(input, buffer, n); break;
+            }
+            tanhTimer.stop();
+
+            sinTimer.start();
+            switch (tier.first)
+            {
+                case MathAccuracy::Exact: FastMath::sin2Pi<MathAccuracy::Exact>(input, buffer, n); break;
+                case MathAccuracy::High:  FastMath::sin2Pi<MathAccuracy::High>(input, buffer, n); break;
+                case MathAccuracy::Fast:  FastMath::sin2Pi<MathAccuracy::Fast>(input, buffer, n); break;
+            }
+            sinTimer.stop();
+
+            exp2Timer.start();
+            switch (tier.first)
+            {
+                case MathAccuracy::Exact: FastMath::exp2<MathAccuracy::Exact>(input, buffer, n); break;
+                case MathAccuracy::High:  FastMath::exp2<MathAccuracy::High>(input, buffer, n); break;
+                case MathAccuracy::Fast:  FastMath::exp2<MathAccuracy::Fast>(input, buffer, n); break;
+            }
+            exp2Timer.stop();
+        }
+
+        printCycles(juce::String(tier.second) + " tanh", tanhTimer.getSeconds());
+        printCycles(juce::String(tier.second) + " sin", sinTimer.getSeconds());
+        printCycles(juce::String(tier.second) + " exp2", exp2Timer.getSeconds());
+
+        sineOSC sine;
+        sawOSC saw;
+        squareOSC square;
+        const std::pair<Oscillator*, const char*> oscillators[] = {
+            { &sine, " sine osc" },
+            { &saw, " saw osc" },
+            { &square, " square osc" }
+        };
+
+        for (auto& osc : oscillators)
+        {
+            osc.first->setSampleRate((float) sampleRate);
+            osc.first->setFrequency(110.0f);
+            osc.first->setMathAccuracy(tier.first);
+
+            StageTimer timer;
+            for (juce::int64 pos = 0; pos < numSamples; pos += blockSize)
+            {
+                int n = (int) juce::jmin((juce::int64) blockSize, numSamples - pos);
+
+                timer.start();
+                osc.first->process(buffer, n);
+                timer.stop();
+            }
+
+            printCycles(juce::String(tier.second) + osc.second, timer.getSeconds());
+        }
+    }
+}
+
+// FilterSynth rendered a sample at a time through the Oscillator pointers,
+// against the block render that dispatches on the oscillator types once per block
+static void benchFilterSynth(double sampleRate, int blockSize, juce::int64 numSamples)
+{
+    auto makeSynth = [sampleRate](FilterSynth& synth)
+    {
+        synth.setSampleRate((float) sampleRate);
+        synth.setOSC(OscType::Square, 110, 0);
+        synth.setLFO(LFOType::Saw, 0.1f, 2200, 0);
+        synth.setFilter(FilterType::LowPass, 2200 + 112, 0.7f);
+        synth.setControlRate(32);
+    };
+
+    FilterSynth perSample, block;
+    makeSynth(perSample);
+    makeSynth(block);
+
+    juce::HeapBlock<float> buffer((size_t) blockSize);
+    StageTimer perSampleTimer, blockTimer;
+
+    for (juce::int64 pos = 0; pos < numSamples; pos += blockSize)
+    {
+        int n = (int) juce::jmin((juce::int64) blockSize, numSamples - pos);
+
+        perSampleTimer.start();
+        for (int i = 0; i < n; i++)
+            buffer[i] = perSample.process(true);
+        perSampleTimer.stop();
+
+        blockTimer.start();
+        block.process(buffer, n, true);
+        blockTimer.stop();
+    }
+
+    std::cout << "  FilterSynth:" << std::endl;
+    printStage("per sample", perSampleTimer.getSeconds(), numSamples);
+    printStage("block", blockTimer.getSeconds(), numSamples);
+    std::cout << "    speedup " << juce::String(perSampleTimer.getSeconds() / blockTimer.getSeconds(), 2) << "x" << std::endl;
+}
+
+// Unison stack cost as the voice count grows, the SIMD stack against one blepSawOSC per voice
+static void benchUnison(double sampleRate, int blockSize, juce::int64 numSamples)
+{
+    std::cout << "  unison (stereo):" << std::endl;
+
+    juce::HeapBlock<float> left((size_t) blockSize), right((size_t) blockSize);
+    double oneVoiceSeconds = 0.0;
+
+    for (int numVoices : { 1, 4, 8, 16 })
+    {
+        UnisonOscillator unison;
+        unison.setSampleRate((float) sampleRate);
+        unison.setFrequency(110.0f);
+        unison.setNumVoices(numVoices);
+        unison.setDetune(25.0f);
+
+        std::vector<blepSawOSC> separate((size_t) numVoices);
+        for (auto& osc : separate)
+        {
+            osc.setSampleRate((float) sampleRate);
+            osc.setFrequency(110.0f);
+        }
+
+        StageTimer unisonTimer, separateTimer;
+        for (juce::int64 pos = 0; pos < numSamples; pos += blockSize)
+        {
+            int n = (int) juce::jmin((juce::int64) blockSize, numSamples - pos);
+
+            unisonTimer.start();
+            unison.process(left, right, n);
+            unisonTimer.stop();
+
+            separateTimer.start();
+            for (auto& osc : separate)
+                osc.process(left, n);
+            separateTimer.stop();
+        }
+
+        if (numVoices == 1)
+            oneVoiceSeconds = unisonTimer.getSeconds();
+
+        printStage(juce::String(numVoices) + " voices", unisonTimer.getSeconds(), numSamples);
+        std::cout << "      " << juce::String(unisonTimer.getSeconds() / oneVoiceSeconds, 2) << "x one voice, "
+                  << numVoices << " blepSawOSC " << juce::String(separateTimer.getSeconds() * 1.0e9 / (double) numSamples, 2)
+                  << " ns/sample" << std::endl;
+    }
+}
+
+// The FDN reverb in stereo with each feedback matrix
+static void benchReverb(double sampleRate, int blockSize, juce::int64 numSamples)
+{
+    const std::pair<FDNMixing, const char*> mixings[] = {
+        { FDNMixing::Hadamard, "hadamard" },
+        { FDNMixing::Householder, "householder" }
+    };
+
+    std::cout << "  reverb (" << FDNReverb::numLines << " lines, stereo):" << std::endl;
+
+    juce::HeapBlock<float> left((size_t) blockSize), right((size_t) blockSize);
+    sawOSC input;
+    input.setSampleRate((float) sampleRate);
+    input.setFrequency(110.0f);
+
+    for (auto& mixing : mixings)
+    {
+        MemoryArena arena;
+        arena.reserve(FDNReverb::getRequiredMemory(sampleRate));
+        auto reverb = std::make_unique<FDNReverb>();
+        reverb->setMixing(mixing.first);
+        reverb->setMix(0.5f);
+        reverb->prepare(sampleRate, sampleRate, arena);
+
+        StageTimer timer;
+        for (juce::int64 pos = 0; pos < numSamples; pos += blockSize)
+        {
+            int n = (int) juce::jmin((juce::int64) blockSize, numSamples - pos);
+            input.process(left, n);
+            std::copy(left.get(), left.get() + n, right.get());
+
+            timer.start();
+            reverb->process(left, right, n);
+            timer.stop();
+        }
+
+        printStage(mixing.second, timer.getSeconds(), numSamples);
+    }
+}
+
+// Audio-rate cutoff modulation: the biquad redesigned every sample against the state-variable filter
+static void benchFilterModulation(double sampleRate, int blockSize, juce::int64 numSamples)
+{
+    const std::pair<FilterType, const char*> filters[] = {
+        { FilterType::LowPass, "biquad" },
+        { FilterType::SVFLowPass, "svf" }
+    };
+
+    std::cout << "  audio-rate cutoff modulation:" << std::endl;
+
+    juce::HeapBlock<float> buffer((size_t) blockSize);
+
+    for (auto& filter : filters)
+    {
+        FilterSynth synth;
+        synth.setSampleRate((float) sampleRate);
+        synth.setOSC(OscType::BlepSaw, 110, 0);
+        synth.setLFO(LFOType::Sine, 220, 2200, 0);
+        synth.setFilter(filter.first, 2200 + 112, 0.7f);
+        synth.setControlRate(1);
+
+        StageTimer timer;
+        for (juce::int64 pos = 0; pos < numSamples; pos += blockSize)
+        {
+            int n = (int) juce::jmin((juce::int64) blockSize, numSamples - pos);
+
+            timer.start();
+            synth.process(buffer, n, false);
+            timer.stop();
+        }
+
+        printStage(filter.second, timer.getSeconds(), numSamples);
+    }
+}
+
+// Cost per sample of the modulation matrix as the routes grow, the sources already rendered
+static void benchModulationMatrix(double sampleRate, int blockSize, juce::int64 numSamples)
+{
+    juce::ignoreUnused(sampleRate);
+    std::cout << "  modulation matrix:" << std::endl;
+
+    for (int numRoutes : { 4, 16, ModulationMatrix::maxRoutes })
+    {
+        ModulationMatrix matrix;
+        matrix.prepare(ModulationMatrix::maxSources, ModulationMatrix::maxDestinations, blockSize);
+
+        for (int r = 0; r < numRoutes; r++)
+            matrix.addRoute(r % ModulationMatrix::maxSources, (r / 3) % ModulationMatrix::maxDestinations, 0.5f);
+
+        for (int source = 0; source < ModulationMatrix::maxSources; source++)
+            juce::FloatVectorOperations::fill(matrix.getSourceBuffer(source), 0.25f * source, blockSize);
+
+        StageTimer timer;
+        for (juce::int64 pos = 0; pos < numSamples; pos += blockSize)
+        {
+            int n = (int) juce::jmin((juce::int64) blockSize, numSamples - pos);
+
+            timer.start();
+            matrix.process(n);
+            timer.stop();
+        }
+
+        printStage(juce::String(numRoutes) + " routes", timer.getSeconds(), numSamples);
+    }
+}
+
+//==============================================================================
+// Null test: the peak difference against a reference render, in dBFS
+static void compareWithReference(const juce::File& file, const juce::AudioBuffer<float>& audio)
+{
+    juce::AudioBuffer<float> reference;
+    if (! readWavFile(file, reference))
+    {
+        std::cout << "Cannot read reference " << file.getFullPathName() << std::endl;
+        return;
+    }
+
+    int numSamples = juce::jmin(audio.getNumSamples(), reference.getNumSamples());
+    int numChannels = juce::jmin(audio.getNumChannels(), reference.getNumChannels());
+
+    float peak = 0.0f;
+    for (int ch = 0; ch < numChannels; ch++)
+        for (int i = 0; i < numSamples; i++)
+            peak = juce::jmax(peak, std::abs(audio.getSample(ch, i) - reference.getSample(ch, i)));
+
+    std::cout << "Null test against " << file.getFileName() << ": peak difference "
+              << juce::Decibels::toString(juce::Decibels::gainToDecibels(peak, -200.0f)) << std::endl;
+}
+
+//==============================================================================
+static BenchSettings parseArguments(int argc, char* argv[])
+{
+    juce::ArgumentList args(argc, argv);
+    BenchSettings settings;
+
+    if (args.containsOption("--seconds"))
+        settings.seconds = args.getValueForOption("--seconds").getDoubleValue();
+
+    if (args.containsOption("--rates"))
+    {
+        settings.sampleRates.clear();
+        for (auto& rate : juce::StringArray::fromTokens(args.getValueForOption("--rates"), ",", {}))
+            settings.sampleRates.add(rate.getDoubleValue());
+    }
+
+    if (args.containsOption("--blocks"))
+    {
+        settings.blockSizes.clear();
+        for (auto& size : juce::StringArray::fromTokens(args.getValueForOption("--blocks"), ",", {}))
+            settings.blockSizes.add(size.getIntValue());
+    }
+
+    if (args.containsOption("--chord"))
+        for (auto& note : juce::StringArray::fromTokens(args.getValueForOption("--chord"), ",", {}))
+            settings.chordNotes.add(note.getIntValue());
+
+    if (args.containsOption("--oversampling"))
+        settings.oversampling = juce::jlimit(0, 3, args.getValueForOption("--oversampling").getIntValue());
+
+    if (args.containsOption("--channels"))
+        settings.numChannels = juce::jlimit(1, 16, args.getValueForOption("--channels").getIntValue());
+
+    if (args.containsOption("--threads"))
+        settings.numWorkerThreads = juce::jlimit(0, WorkerPool::maxWorkers, args.getValueForOption("--threads").getIntValue());
+
+    if (args.containsOption("--wav"))
+        settings.wavFile = args.getFileForOption("--wav");
+
+    if (args.containsOption("--null"))
+        settings.referenceFile = args.getFileForOption("--null");
+
+    if (args.containsOption("--golden"))
+        settings.golden.directory = args.getFileForOption("--golden");
+
+    if (args.containsOption("--tolerance"))
+        settings.golden.tolerance = juce::jmax(0.0f, args.getValueForOption("--tolerance").getFloatValue());
+
+    settings.golden.update = args.containsOption("--update");
+    settings.golden.sampleRate = settings.sampleRates.getFirst();
+    settings.golden.blockSize = settings.blockSizes.getFirst();
+
+    return settings;
+}
+
+int main(int argc, char* argv[])
+{
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+    auto settings = parseArguments(argc, argv);
+
+    if (settings.golden.directory != juce::File())
+        return runGoldenRenders(settings.golden) == 0 ? 0 : 1;
+
+    for (auto sampleRate : settings.sampleRates)
+    {
+        for (auto blockSize : settings.blockSizes)
+        {
+            auto numSamples = (juce::int64) (settings.seconds * sampleRate);
+            double stepSeconds[PerformanceMonitor::numSteps] = {};
+            double seconds = renderProcessor(sampleRate, blockSize, numSamples, settings, nullptr, &stepSeconds);
+
+            std::cout << juce::String(sampleRate, 0) << " Hz, block " << blockSize << ": "
+                      << juce::String(seconds * 1.0e9 / (double) numSamples, 2) << " ns/sample, "
+                      << juce::String(settings.seconds / seconds, 1) << "x real time" << std::endl;
+
+            printSteps(stepSeconds, numSamples);
+            benchDelayInterpolation(sampleRate, blockSize, numSamples);
+            benchOscillators(sampleRate, blockSize, numSamples);
+            benchMathAccuracy(sampleRate, blockSize, numSamples);
+            benchFilterSynth(sampleRate, blockSize, numSamples);
+            benchUnison(sampleRate, blockSize, numSamples);
+            benchReverb(sampleRate, blockSize, numSamples);
+            benchFilterModulation(sampleRate, blockSize, numSamples);
+            benchModulationMatrix(sampleRate, blockSize, numSamples);
+        }
+    }
+
+    // Offline render at the first configuration, for listening and null tests
+    if (settings.wavFile != juce::File() || settings.referenceFile != juce::File())
+    {
+        double sampleRate = settings.sampleRates.getFirst();
+        juce::AudioBuffer<float> audio;
+        renderProcessor(sampleRate, settings.blockSizes.getFirst(),
+                        (juce::int64) (settings.seconds * sampleRate), settings, &audio);
+
+        if (settings.wavFile != juce::File())
+        {
+            if (writeWavFile(settings.wavFile, audio, sampleRate))
+                std::cout << "Wrote " << settings.wavFile.getFullPathName() << std::endl;
+            else
+                std::cout << "Cannot write " << settings.wavFile.getFullPathName() << std::endl;
+        }
+
+        if (settings.referenceFile != juce::File())
+            compareWithReference(settings.referenceFile, audio);
+    }
+
+    return 0;
+}